@@ -0,0 +1,323 @@
+use std::fmt::{self, Debug};
+use std::io::{Cursor, Seek, SeekFrom};
+use std::sync::OnceLock;
+
+use binrw::BinReaderExt;
+use rayon::iter::{IntoParallelIterator, IntoParallelRefIterator, ParallelIterator};
+
+use super::{
+    ExtractInner, HierarchyObject, HierarchyObjectHeader, HierarchyObjectKind, HierarchyObjectType,
+    decode_object,
+};
+
+/// A hierarchy chunk whose objects are only located, not decoded: each keeps its header and a
+/// view of the bank, and is decoded the first time it is accessed. Finding out what a bank
+/// contains costs one pass over the object headers, see [Self::has_type].
+#[derive(Debug, Clone)]
+pub struct BorrowedHierarchyChunk<'a> {
+    pub object_count: u32,
+    pub objects: Vec<BorrowedHierarchyObject<'a>>,
+}
+
+impl<'a> BorrowedHierarchyChunk<'a> {
+    /// Locates the `object_count` objects starting at the position of `cur`, leaving it past the
+    /// last one.
+    pub fn read_objects(cur: &mut Cursor<&'a [u8]>, object_count: u32) -> anyhow::Result<Self> {
+        #[cfg(feature = "profiler")]
+        profiling::scope!("BorrowedHierarchyChunk::read_objects");
+        let bank: &'a [u8] = *cur.get_ref();
+        let mut objects = Vec::with_capacity(object_count as usize);
+        for _ in 0..object_count {
+            let pos = cur.position();
+            let header: HierarchyObjectHeader = cur.read_le()?;
+            // The length of types past 32 counts the header in.
+            let base = if header.ty > 32 { pos } else { pos + 5 };
+            let end = (base + header.len as u64).min(bank.len() as u64);
+            objects.push(BorrowedHierarchyObject {
+                header,
+                bank,
+                body: pos as usize + 5,
+                end: end as usize,
+                obj: OnceLock::new(),
+            });
+            cur.seek(SeekFrom::Start(end))?;
+        }
+
+        Ok(Self {
+            object_count,
+            objects,
+        })
+    }
+
+    /// Whether the chunk has objects of type `T`, from their headers alone.
+    pub fn has_type<T: HierarchyObjectKind>(&self) -> bool {
+        self.objects.iter().any(|o| o.header.ty == T::TYPE)
+    }
+
+    /// Number of objects of type `T`, from their headers alone.
+    pub fn count_by_type<T: HierarchyObjectKind>(&self) -> usize {
+        self.objects
+            .iter()
+            .filter(|o| o.header.ty == T::TYPE)
+            .count()
+    }
+
+    /// Decodes the objects of type `T`, and only them.
+    pub fn get_all_by_type<T>(&self) -> anyhow::Result<Vec<&T>>
+    where
+        HierarchyObjectType: ExtractInner<T>,
+        T: HierarchyObjectKind + Send + Sync,
+    {
+        #[cfg(feature = "profiler")]
+        profiling::scope!("BorrowedHierarchyChunk::get_all_by_type");
+        self.objects
+            .par_iter()
+            .filter_map(|o| o.extract::<T>().transpose())
+            .collect()
+    }
+
+    /// Decodes the objects of type `T` and keeps the ones matching `predicate`.
+    pub fn filter_objects<F, T>(&self, predicate: F) -> anyhow::Result<Vec<&T>>
+    where
+        F: Fn(&T) -> bool + Sync,
+        HierarchyObjectType: ExtractInner<T>,
+        T: HierarchyObjectKind + Send + Sync,
+    {
+        #[cfg(feature = "profiler")]
+        profiling::scope!("BorrowedHierarchyChunk::filter_objects");
+        let objects = self.get_all_by_type::<T>()?;
+        Ok(objects.into_iter().filter(|o| predicate(o)).collect())
+    }
+
+    /// Decodes every object that wasn't yet, in parallel, into owned objects.
+    pub fn into_owned(self) -> anyhow::Result<Vec<HierarchyObject>> {
+        #[cfg(feature = "profiler")]
+        profiling::scope!("BorrowedHierarchyChunk::into_owned");
+        self.objects
+            .into_par_iter()
+            .map(BorrowedHierarchyObject::into_owned)
+            .collect()
+    }
+}
+
+/// An object of a [BorrowedHierarchyChunk], decoded on first access by [Self::obj].
+#[derive(Clone)]
+pub struct BorrowedHierarchyObject<'a> {
+    pub header: HierarchyObjectHeader,
+    bank: &'a [u8],
+    /// Offset of the body in `bank`, right after the header.
+    body: usize,
+    /// End of the object in `bank`.
+    end: usize,
+    obj: OnceLock<HierarchyObjectType>,
+}
+
+impl<'a> BorrowedHierarchyObject<'a> {
+    /// The body of the object, as stored in the bank.
+    pub fn data(&self) -> &'a [u8] {
+        &self.bank[self.body.min(self.end)..self.end]
+    }
+
+    /// The decoded object. A failed decode isn't kept, the next access tries again.
+    pub fn obj(&self) -> anyhow::Result<&HierarchyObjectType> {
+        if let Some(obj) = self.obj.get() {
+            return Ok(obj);
+        }
+
+        // Objects are decoded from the bank rather than from data(), like they always were.
+        let obj = decode_object(&self.header, &mut Cursor::new(&self.bank[self.body..]))?;
+        Ok(self.obj.get_or_init(|| obj))
+    }
+
+    /// The object as a `T`, `None` without decoding it if it is of another type.
+    pub fn extract<T>(&self) -> anyhow::Result<Option<&T>>
+    where
+        HierarchyObjectType: ExtractInner<T>,
+        T: HierarchyObjectKind,
+    {
+        if self.header.ty != T::TYPE {
+            return Ok(None);
+        }
+        Ok(self.obj()?.extract_inner())
+    }
+
+    pub fn into_owned(self) -> anyhow::Result<HierarchyObject> {
+        let obj = match self.obj.into_inner() {
+            Some(obj) => obj,
+            None => decode_object(&self.header, &mut Cursor::new(&self.bank[self.body..]))?,
+        };
+        Ok(HierarchyObject {
+            header: self.header,
+            obj,
+        })
+    }
+}
+
+impl Debug for BorrowedHierarchyObject<'_> {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        // Not the bank, which it would print whole.
+        f.debug_struct("BorrowedHierarchyObject")
+            .field("header", &self.header)
+            .field("len", &self.data().len())
+            .field("obj", &self.obj.get())
+            .finish()
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::hierarchy::event::Event;
+    use crate::hierarchy::music::{MusicPlaylistContainer, MusicSegment};
+    use crate::hierarchy::{HierarchyChunk, HierarchyObjectType};
+
+    /// Appends an object of type `ty` with `body`, its length counting the header in past 32.
+    fn push_object(bank: &mut Vec<u8>, ty: u8, body: &[u8]) {
+        let len = if ty > 32 { body.len() + 5 } else { body.len() };
+        bank.push(ty);
+        bank.extend_from_slice(&(len as u32).to_le_bytes());
+        bank.extend_from_slice(body);
+    }
+
+    fn event_body(id: u32, action_ids: &[u32]) -> Vec<u8> {
+        let mut body = id.to_le_bytes().to_vec();
+        body.push(action_ids.len() as u8);
+        for action_id in action_ids {
+            body.extend_from_slice(&action_id.to_le_bytes());
+        }
+        body
+    }
+
+    /// Some bytes before the objects, so offsets don't start at 0, and a trailer after them.
+    fn fixture(objects: &[(u8, Vec<u8>)]) -> (Vec<u8>, u64, u64) {
+        let mut bank = vec![0xaa; 7];
+        let start = bank.len() as u64;
+        for (ty, body) in objects {
+            push_object(&mut bank, *ty, body);
+        }
+        let end = bank.len() as u64;
+        bank.extend_from_slice(&[0xbb; 3]);
+        (bank, start, end)
+    }
+
+    /// Decodes the objects one after the other, as `HierarchyChunk::read_hierarchy` used to.
+    fn read_sequential(
+        bank: &[u8],
+        start: u64,
+        count: u32,
+    ) -> Vec<(HierarchyObjectHeader, HierarchyObjectType)> {
+        let mut cur = Cursor::new(bank);
+        cur.set_position(start);
+        let mut objects = vec![];
+        for _ in 0..count {
+            let pos = cur.position();
+            let header: HierarchyObjectHeader = cur.read_le().unwrap();
+            let base = if header.ty > 32 { pos } else { pos + 5 };
+            let obj = decode_object(&header, &mut cur).unwrap();
+            cur.set_position(base + header.len as u64);
+            objects.push((header, obj));
+        }
+        objects
+    }
+
+    #[test]
+    fn into_owned_matches_sequential_decode() {
+        let objects = vec![
+            (1, vec![0; 12]),
+            (4, event_body(0x1234, &[1, 2, 3])),
+            (2, vec![0; 3]),
+            (4, event_body(0x5678, &[])),
+            (4, event_body(0x9abc, &[4])),
+        ];
+        let (bank, start, end) = fixture(&objects);
+        let expected = read_sequential(&bank, start, objects.len() as u32);
+
+        let mut cur = Cursor::new(bank.as_slice());
+        cur.set_position(start);
+        let borrowed =
+            BorrowedHierarchyChunk::read_objects(&mut cur, objects.len() as u32).unwrap();
+        assert_eq!(cur.position(), end);
+        assert_eq!(borrowed.count_by_type::<Event>(), 3);
+        let events = borrowed.get_all_by_type::<Event>().unwrap();
+        assert_eq!(
+            events.iter().map(|e| e.id).collect::<Vec<_>>(),
+            vec![0x1234, 0x5678, 0x9abc]
+        );
+
+        // Some objects decoded already, the others decoded by into_owned.
+        let owned = borrowed.into_owned().unwrap();
+        assert_eq!(owned.len(), expected.len());
+        for (object, (header, obj)) in owned.iter().zip(&expected) {
+            assert_eq!(object.header.ty, header.ty);
+            assert_eq!(object.header.len, header.len);
+            assert_eq!(&object.obj, obj);
+        }
+
+        let mut chunk = HierarchyChunk {
+            object_count: objects.len() as u32,
+            objects: vec![],
+        };
+        let mut cur = Cursor::new(bank.as_slice());
+        cur.set_position(start);
+        chunk.read_hierarchy(&mut cur).unwrap();
+        assert_eq!(cur.position(), end);
+        let decoded: Vec<_> = chunk.objects.iter().map(|o| &o.obj).collect();
+        let expected: Vec<_> = expected.iter().map(|(_, obj)| obj).collect();
+        assert_eq!(decoded, expected);
+    }
+
+    #[test]
+    fn types_past_32_count_their_header_in() {
+        let objects = vec![
+            (4, event_body(1, &[2])),
+            (40, vec![0xcc; 9]),
+            (33, vec![]),
+            (4, event_body(3, &[4, 5])),
+        ];
+        let (bank, start, end) = fixture(&objects);
+
+        let mut cur = Cursor::new(bank.as_slice());
+        cur.set_position(start);
+        let borrowed =
+            BorrowedHierarchyChunk::read_objects(&mut cur, objects.len() as u32).unwrap();
+        assert_eq!(cur.position(), end);
+        for (object, (ty, body)) in borrowed.objects.iter().zip(&objects) {
+            assert_eq!(object.header.ty, *ty);
+            assert_eq!(object.data(), body.as_slice());
+        }
+
+        // Objects of other types are located past, never decoded.
+        let events = borrowed.get_all_by_type::<Event>().unwrap();
+        assert_eq!(
+            events
+                .iter()
+                .map(|e| (e.id, e.action_ids.clone()))
+                .collect::<Vec<_>>(),
+            vec![(1, vec![2]), (3, vec![4, 5])]
+        );
+        assert!(borrowed.objects[1].obj().is_err());
+    }
+
+    #[test]
+    fn undecodable_music_nodes_stay_opaque() {
+        // Each alone in its bank, so decoding runs out of data.
+        let decode = |ty: u8| {
+            let (bank, start, _) = fixture(&[(ty, vec![0; 3])]);
+            let mut cur = Cursor::new(bank.as_slice());
+            cur.set_position(start);
+            let borrowed = BorrowedHierarchyChunk::read_objects(&mut cur, 1).unwrap();
+            borrowed.objects[0].obj().cloned()
+        };
+
+        assert_eq!(
+            decode(MusicSegment::TYPE).unwrap(),
+            HierarchyObjectType::MusicSegment(MusicSegment::default())
+        );
+        assert_eq!(
+            decode(MusicPlaylistContainer::TYPE).unwrap(),
+            HierarchyObjectType::MusicPlaylistContainer(MusicPlaylistContainer::default())
+        );
+        // Other types still fail.
+        assert!(decode(Event::TYPE).is_err());
+    }
+}
@@ -0,0 +1,266 @@
+use std::collections::{HashMap, HashSet};
+
+use super::{HierarchyChunk, HierarchyObjectType, music::*};
+
+/// `Sound::source` of media embedded in the bank.
+pub const SOUND_SOURCE_BANK: u8 = 0;
+/// `Sound::source` of streamed media whose beginning is embedded in the bank (prefetch-streamed).
+pub const SOUND_SOURCE_PREFETCH: u8 = 1;
+
+/// A media file that a music track reads from outside of its bank.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub struct TrackMedia {
+    pub audio_id: u32,
+    pub source: u8,
+    /// `MusicTrack::look_ahead_time` of the track: how long, in milliseconds, before the track
+    /// plays the engine starts streaming it.
+    pub look_ahead_time: u32,
+}
+
+/// The music nodes of a hierarchy and the streamed media under them, to find every file a music
+/// switch or segment can reach before it plays.
+#[derive(Debug, Default, Clone)]
+pub struct MusicMediaGraph {
+    /// Node -> nodes it can play: children, transition segments and, for segments, their tracks.
+    children: HashMap<u32, Vec<u32>>,
+    /// Track -> its media that isn't embedded in the bank.
+    media: HashMap<u32, Vec<TrackMedia>>,
+    switches: Vec<MusicSwitchContainer>,
+}
+
+impl MusicMediaGraph {
+    pub fn new(hirc: &HierarchyChunk) -> Self {
+        #[cfg(feature = "profiler")]
+        profiling::scope!("MusicMediaGraph::new");
+        let mut graph = Self::default();
+        for object in &hirc.objects {
+            match &object.obj {
+                HierarchyObjectType::MusicTrack(track) => {
+                    let media = track
+                        .sounds
+                        .iter()
+                        .filter(|s| s.source != SOUND_SOURCE_BANK)
+                        .map(|s| TrackMedia {
+                            audio_id: s.audio_id,
+                            source: s.source,
+                            look_ahead_time: track.look_ahead_time,
+                        })
+                        .collect::<Vec<_>>();
+                    if !media.is_empty() {
+                        graph.media.insert(track.id, media);
+                    }
+                    // Segments aren't always listed with their tracks, the parent link is.
+                    graph.add_children(track.properties.parent_id, &[track.id]);
+                }
+                HierarchyObjectType::MusicSegment(segment) => {
+                    graph.add_children(segment.id, &segment.child_ids);
+                }
+                HierarchyObjectType::MusicPlaylistContainer(playlist) => {
+                    graph.add_children(playlist.id, &playlist.child_ids);
+                }
+                HierarchyObjectType::MusicSwitchContainer(switch) => {
+                    graph.add_children(switch.id, &switch.child_ids);
+                    let transition_segments = switch
+                        .transitions
+                        .iter()
+                        .filter(|t| t.use_transition_segment == 1)
+                        .map(|t| t.transition_segment.id)
+                        .collect::<Vec<_>>();
+                    graph.add_children(switch.id, &transition_segments);
+                    graph.switches.push(switch.clone());
+                }
+                _ => {}
+            }
+        }
+
+        graph
+    }
+
+    fn add_children(&mut self, parent: u32, children: &[u32]) {
+        let list = self.children.entry(parent).or_default();
+        for child in children {
+            if !list.contains(child) {
+                list.push(*child);
+            }
+        }
+    }
+
+    /// Every streamed file that `root` can play, each once, most urgent first: fully streamed
+    /// files before prefetch-streamed ones (whose beginning is in the bank), then by increasing
+    /// look-ahead time.
+    pub fn reachable_from(&self, root: u32) -> Vec<TrackMedia> {
+        self.reachable_from_all(&[root])
+    }
+
+    /// Every streamed file that the endpoints selected by `state` of switch group `group` can
+    /// play, in the order of [Self::reachable_from]. Where no path names `state`, the default
+    /// path (the one that accepts any state) is followed instead, as the engine does.
+    pub fn reachable_from_switch(&self, group: u32, state: u32) -> Vec<TrackMedia> {
+        let mut roots = vec![];
+        for switch in &self.switches {
+            if let Some(depth) = switch.group_ids.iter().position(|g| *g == group) {
+                collect_endpoints(&switch.paths.children, 0, depth, state, false, &mut roots);
+            }
+        }
+
+        self.reachable_from_all(&roots)
+    }
+
+    fn reachable_from_all(&self, roots: &[u32]) -> Vec<TrackMedia> {
+        let mut visited = HashSet::new();
+        let mut pending = roots.to_vec();
+        let mut media: HashMap<u32, TrackMedia> = HashMap::new();
+        while let Some(node) = pending.pop() {
+            if !visited.insert(node) {
+                continue;
+            }
+
+            for m in self.media.get(&node).into_iter().flatten() {
+                // A file shared by several tracks is as urgent as its most urgent track.
+                let entry = media.entry(m.audio_id).or_insert(*m);
+                entry.look_ahead_time = entry.look_ahead_time.min(m.look_ahead_time);
+            }
+            if let Some(children) = self.children.get(&node) {
+                pending.extend(children.iter().filter(|c| !visited.contains(*c)));
+            }
+        }
+
+        let mut media = media.into_values().collect::<Vec<_>>();
+        media.sort_by_key(|m| {
+            (
+                m.source == SOUND_SOURCE_PREFETCH,
+                m.look_ahead_time,
+                m.audio_id,
+            )
+        });
+        media
+    }
+}
+
+/// `from_id` of the paths that accept any state, taken when none names the state.
+const DEFAULT_PATH_ID: u32 = 0;
+
+/// Collects the `audio_id`s of the endpoints under `elements` (at `depth` of the path tree) whose
+/// path goes through `state` at depth `state_depth`, or through the default path there if no
+/// sibling names `state`.
+fn collect_endpoints(
+    elements: &[AudioPathElement],
+    depth: usize,
+    state_depth: usize,
+    state: u32,
+    matched: bool,
+    out: &mut Vec<u32>,
+) {
+    let selected_id = (depth == state_depth).then(|| {
+        let explicit = elements.iter().any(|element| match element {
+            AudioPathElement::AudioPath(node) => node.from_id == state,
+            AudioPathElement::MusicEndpoint(endpoint) => endpoint.from_id == state,
+            AudioPathElement::None => false,
+        });
+        if explicit { state } else { DEFAULT_PATH_ID }
+    });
+
+    for element in elements {
+        match element {
+            AudioPathElement::AudioPath(node) => {
+                let selected = match selected_id {
+                    Some(id) => node.from_id == id,
+                    None => matched || depth < state_depth,
+                };
+                if selected {
+                    collect_endpoints(
+                        &node.children,
+                        depth + 1,
+                        state_depth,
+                        state,
+                        matched || depth == state_depth,
+                        out,
+                    );
+                }
+            }
+            AudioPathElement::MusicEndpoint(endpoint) => {
+                let selected = match selected_id {
+                    Some(id) => endpoint.from_id == id,
+                    None => matched,
+                };
+                if selected {
+                    out.push(endpoint.audio_id);
+                }
+            }
+            AudioPathElement::None => {}
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn node(from_id: u32, children: Vec<AudioPathElement>) -> AudioPathElement {
+        AudioPathElement::AudioPath(AudioPathNode {
+            from_id,
+            children,
+            ..Default::default()
+        })
+    }
+
+    fn endpoint(from_id: u32, audio_id: u32) -> AudioPathElement {
+        AudioPathElement::MusicEndpoint(MusicPathEndpoint {
+            from_id,
+            audio_id,
+            ..Default::default()
+        })
+    }
+
+    /// Two switch groups: 1/2 at depth 0, 10/20 at depth 1, one branch going a level deeper.
+    fn paths() -> Vec<AudioPathElement> {
+        vec![
+            node(
+                1,
+                vec![
+                    endpoint(10, 110),
+                    endpoint(20, 120),
+                    node(10, vec![endpoint(0, 1100), endpoint(7, 1107)]),
+                ],
+            ),
+            node(2, vec![endpoint(10, 210), endpoint(20, 220)]),
+            AudioPathElement::None,
+        ]
+    }
+
+    fn endpoints(paths: &[AudioPathElement], state_depth: usize, state: u32) -> Vec<u32> {
+        let mut out = vec![];
+        collect_endpoints(paths, 0, state_depth, state, false, &mut out);
+        out
+    }
+
+    #[test]
+    fn collect_endpoints_selects_at_state_depth() {
+        // Everything under the matching node, at any depth below it.
+        assert_eq!(endpoints(&paths(), 0, 1), vec![110, 120, 1100, 1107]);
+        assert_eq!(endpoints(&paths(), 0, 2), vec![210, 220]);
+        // Every branch above state_depth, only the matching ones at it.
+        assert_eq!(endpoints(&paths(), 1, 10), vec![110, 1100, 1107, 210]);
+        assert_eq!(endpoints(&paths(), 1, 20), vec![120, 220]);
+        // Only the branch that reaches depth 2.
+        assert_eq!(endpoints(&paths(), 2, 7), vec![1107]);
+        // A state of another depth selects nothing.
+        assert_eq!(endpoints(&paths(), 0, 10), Vec::<u32>::new());
+        assert_eq!(endpoints(&paths(), 1, 1), Vec::<u32>::new());
+    }
+
+    #[test]
+    fn collect_endpoints_follows_default_path() {
+        let paths = vec![
+            node(1, vec![endpoint(10, 110), endpoint(DEFAULT_PATH_ID, 100)]),
+            node(DEFAULT_PATH_ID, vec![endpoint(10, 10), endpoint(20, 20)]),
+        ];
+
+        // A path naming the state wins over the default one.
+        assert_eq!(endpoints(&paths, 0, 1), vec![110, 100]);
+        assert_eq!(endpoints(&paths, 1, 10), vec![110, 10]);
+        // Without one, the default path is taken.
+        assert_eq!(endpoints(&paths, 0, 2), vec![10, 20]);
+        assert_eq!(endpoints(&paths, 1, 30), vec![100]);
+    }
+}
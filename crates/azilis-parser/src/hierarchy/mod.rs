@@ -1,13 +1,16 @@
 pub mod audio;
+pub mod borrowed;
 pub mod event;
+pub mod media;
 pub mod music;
 
-use std::io::{Cursor, Seek, SeekFrom};
+use std::io::Cursor;
 
 use event::*;
 use music::*;
 
-use binrw::{BinRead, BinReaderExt};
+use binrw::BinRead;
+use borrowed::BorrowedHierarchyChunk;
 use rayon::iter::{IntoParallelRefIterator, IntoParallelRefMutIterator, ParallelIterator};
 
 #[derive(BinRead, Debug, Default, Clone, PartialEq)]
@@ -37,7 +40,7 @@ pub enum HierarchyObjectType {
     #[br(pre_assert(h.ty == 9))]
     BlendContainer,
     #[br(pre_assert(h.ty == 10))]
-    MusicSegment,
+    MusicSegment(MusicSegment),
 
     #[br(pre_assert(h.ty == 11))]
     MusicTrack(MusicTrack),
@@ -45,7 +48,7 @@ pub enum HierarchyObjectType {
     #[br(pre_assert(h.ty == 12))]
     MusicSwitchContainer(MusicSwitchContainer),
     #[br(pre_assert(h.ty == 13))]
-    MusicPlaylistContainer,
+    MusicPlaylistContainer(MusicPlaylistContainer),
     #[br(pre_assert(h.ty == 14))]
     Attenuation,
     #[br(pre_assert(h.ty == 15))]
@@ -76,10 +79,10 @@ impl From<u8> for HierarchyObjectType {
             7 => Self::ActorMixer,
             8 => Self::AudioBus,
             9 => Self::BlendContainer,
-            10 => Self::MusicSegment,
+            10 => Self::MusicSegment(MusicSegment::default()),
             11 => Self::MusicTrack(MusicTrack::default()),
             12 => Self::MusicSwitchContainer(MusicSwitchContainer::default()),
-            13 => Self::MusicPlaylistContainer,
+            13 => Self::MusicPlaylistContainer(MusicPlaylistContainer::default()),
             14 => Self::Attenuation,
             15 => Self::DialogueEvent,
             16 => Self::MotionBus,
@@ -92,6 +95,59 @@ impl From<u8> for HierarchyObjectType {
     }
 }
 
+/// Decodes an object of type `header.ty` whose body starts at the position of `cur`.
+///
+/// Music segments and playlist containers are only read for their child lists. One whose layout
+/// doesn't match is left opaque (the default of its type) rather than failing the whole bank.
+pub(crate) fn decode_object(
+    header: &HierarchyObjectHeader,
+    cur: &mut Cursor<&[u8]>,
+) -> anyhow::Result<HierarchyObjectType> {
+    let mut obj = match HierarchyObjectType::read_le_args(cur, binrw::args! {h: header.clone()}) {
+        Ok(obj) => obj,
+        Err(_) if header.ty == MusicSegment::TYPE || header.ty == MusicPlaylistContainer::TYPE => {
+            HierarchyObjectType::from(header.ty)
+        }
+        Err(e) => return Err(e.into()),
+    };
+    // Generate paths for Music Switch Containers
+    if let HierarchyObjectType::MusicSwitchContainer(switch) = &mut obj {
+        if let AudioPathElement::AudioPath(node) = switch.read_path_element(0)? {
+            switch.paths = node;
+        }
+    }
+    Ok(obj)
+}
+
+/// Object types that can be recognized from their header alone, see [HierarchyObjectHeader::ty].
+pub trait HierarchyObjectKind {
+    const TYPE: u8;
+}
+
+impl HierarchyObjectKind for EventAction {
+    const TYPE: u8 = 3;
+}
+
+impl HierarchyObjectKind for Event {
+    const TYPE: u8 = 4;
+}
+
+impl HierarchyObjectKind for MusicSegment {
+    const TYPE: u8 = 10;
+}
+
+impl HierarchyObjectKind for MusicTrack {
+    const TYPE: u8 = 11;
+}
+
+impl HierarchyObjectKind for MusicSwitchContainer {
+    const TYPE: u8 = 12;
+}
+
+impl HierarchyObjectKind for MusicPlaylistContainer {
+    const TYPE: u8 = 13;
+}
+
 pub trait ExtractInner<T> {
     fn extract_inner(&self) -> Option<&T>;
     fn extract_inner_mut(&mut self) -> Option<&mut T>;
@@ -194,6 +250,54 @@ impl ExtractInner<MusicSwitchContainer> for HierarchyObjectType {
     }
 }
 
+impl ExtractInner<MusicSegment> for HierarchyObjectType {
+    fn extract_inner(&self) -> Option<&MusicSegment> {
+        if let HierarchyObjectType::MusicSegment(inner) = self {
+            Some(inner)
+        } else {
+            None
+        }
+    }
+    fn extract_inner_mut(&mut self) -> Option<&mut MusicSegment> {
+        if let HierarchyObjectType::MusicSegment(inner) = self {
+            Some(inner)
+        } else {
+            None
+        }
+    }
+    fn extract_inner_cloned(&self) -> Option<MusicSegment> {
+        if let HierarchyObjectType::MusicSegment(inner) = self {
+            Some(inner.clone())
+        } else {
+            None
+        }
+    }
+}
+
+impl ExtractInner<MusicPlaylistContainer> for HierarchyObjectType {
+    fn extract_inner(&self) -> Option<&MusicPlaylistContainer> {
+        if let HierarchyObjectType::MusicPlaylistContainer(inner) = self {
+            Some(inner)
+        } else {
+            None
+        }
+    }
+    fn extract_inner_mut(&mut self) -> Option<&mut MusicPlaylistContainer> {
+        if let HierarchyObjectType::MusicPlaylistContainer(inner) = self {
+            Some(inner)
+        } else {
+            None
+        }
+    }
+    fn extract_inner_cloned(&self) -> Option<MusicPlaylistContainer> {
+        if let HierarchyObjectType::MusicPlaylistContainer(inner) = self {
+            Some(inner.clone())
+        } else {
+            None
+        }
+    }
+}
+
 #[derive(BinRead, Debug, Clone, Default)]
 pub struct HierarchyChunk {
     pub object_count: u32,
@@ -202,35 +306,14 @@ pub struct HierarchyChunk {
 }
 
 impl HierarchyChunk {
-    pub fn read_hierarchy(
-        &mut self,
-        cur: &mut Cursor<&[u8]>,
-    ) -> anyhow::Result<Vec<HierarchyObject>> {
+    /// Reads and decodes the `object_count` objects starting at the position of `cur`, leaving it
+    /// past the last one. The objects are located first, then decoded in parallel.
+    pub fn read_hierarchy(&mut self, cur: &mut Cursor<&[u8]>) -> anyhow::Result<()> {
         #[cfg(feature = "profiler")]
         profiling::scope!("HierarchyChunk::read_hierarchy");
-        for _ in 0..self.object_count {
-            let t: u8 = cur.read_le()?;
-            cur.seek_relative(-1)?;
-            let pos = cur.position();
-            let mut a = pos + 5;
-            if t > 32 {
-                a -= 5;
-                cur.seek(SeekFrom::Start(a))?;
-            }
-            let mut object: HierarchyObject = cur.read_le()?;
-            let end = a + object.header.len as u64;
-            #[cfg(feature = "profiler")]
-            profiling::scope!(
-                "HierarchyChunk::read_hierarchy.inner",
-                format!("pos {}, len {}, end {}", pos, object.header.len, end).as_str()
-            );
-            let obj =
-                HierarchyObjectType::read_le_args(cur, binrw::args! {h: object.header.clone()})?;
-            object.obj = obj;
-            cur.seek(SeekFrom::Start(end))?;
-            self.objects.push(object);
-        }
-        Ok(self.objects.clone())
+        self.objects =
+            BorrowedHierarchyChunk::read_objects(cur, self.object_count)?.into_owned()?;
+        Ok(())
     }
 
     pub fn get_all_by_type<T>(&self) -> Vec<&T>
@@ -106,6 +106,32 @@ pub struct MusicSwitchParams {
     pub fade_in_offset: u32,
 }
 
+/// Only the common music node header is read, enough to walk the hierarchy down to the tracks.
+#[derive(BinRead, Default, Debug, Clone, PartialEq)]
+pub struct MusicSegment {
+    pub id: u32,
+    pub midi_behaviour: u8,
+    pub properties: AudioProperties,
+
+    _child_count: u32,
+    /// Tracks of the segment.
+    #[br(count = _child_count)]
+    pub child_ids: Vec<u32>,
+}
+
+/// Only the common music node header is read, enough to walk the hierarchy down to the tracks.
+#[derive(BinRead, Default, Debug, Clone, PartialEq)]
+pub struct MusicPlaylistContainer {
+    pub id: u32,
+    pub midi_behaviour: u8,
+    pub properties: AudioProperties,
+
+    _child_count: u32,
+    /// Segments and nested playlists.
+    #[br(count = _child_count)]
+    pub child_ids: Vec<u32>,
+}
+
 #[derive(BinRead, Default, Debug, Clone, PartialEq)]
 pub struct MusicSwitchContainer {
     pub id: u32,
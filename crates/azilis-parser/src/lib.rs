@@ -1,7 +1,7 @@
 // #![feature(const_copy_from_slice)]
 
 pub mod hierarchy;
-use hierarchy::{music::AudioPathElement, *};
+use hierarchy::{borrowed::BorrowedHierarchyChunk, *};
 
 use anyhow::Result;
 use binrw::{BinRead, BinReaderExt};
@@ -104,18 +104,6 @@ pub fn parse(data: &[u8]) -> Result<Vec<SoundbankChunk>> {
         match &mut c.chunk {
             SoundbankChunkTypes::Hierarchy(hirc) => {
                 hirc.read_hierarchy(&mut cur)?;
-                // Generate paths for Music Switch Containers
-                hirc.objects
-                    .iter_mut()
-                    .try_for_each(|f| -> anyhow::Result<()> {
-                        if let HierarchyObjectType::MusicSwitchContainer(switch) = &mut f.obj {
-                            let path = switch.read_path_element(0)?;
-                            if let AudioPathElement::AudioPath(node) = path {
-                                switch.paths = node;
-                            }
-                        }
-                        Ok(())
-                    })?;
             }
             // TODO: INIT, STMG, DIDX, etc.
             _ => {}
@@ -126,3 +114,36 @@ pub fn parse(data: &[u8]) -> Result<Vec<SoundbankChunk>> {
 
     Ok(chunks)
 }
+
+/// The chunks of a soundbank read by [parse_borrowed].
+#[derive(Debug, Default)]
+pub struct BorrowedSoundbank<'a> {
+    pub header: Option<BankHeaderChunk>,
+    pub hierarchy: Option<BorrowedHierarchyChunk<'a>>,
+}
+
+/// Like [parse], except that hierarchy objects are only located, not decoded or copied: they are
+/// decoded from `data` on first access, see [BorrowedHierarchyChunk].
+pub fn parse_borrowed(data: &[u8]) -> Result<BorrowedSoundbank<'_>> {
+    #[cfg(feature = "profiler")]
+    profiling::scope!("parser::parse_borrowed");
+    let mut bank = BorrowedSoundbank::default();
+    let mut cur = Cursor::new(data);
+    for _ in 0..2 {
+        let c: SoundbankChunk = cur
+            .read_le()
+            .map_err(|_| anyhow::anyhow!("Invalid Soundbank Header"))?;
+        match c.chunk {
+            SoundbankChunkTypes::BankHeader(header) => bank.header = Some(header),
+            SoundbankChunkTypes::Hierarchy(hirc) => {
+                bank.hierarchy = Some(BorrowedHierarchyChunk::read_objects(
+                    &mut cur,
+                    hirc.object_count,
+                )?);
+            }
+            _ => {}
+        }
+    }
+
+    Ok(bank)
+}
@@ -4,12 +4,13 @@ use destiny_pkg::package::UEntryHeader;
 use eframe::egui::{self, Context, RichText, Ui};
 use itertools::Itertools;
 use log::warn;
-use parser::{SoundbankChunkTypes, hierarchy::music::MusicSwitchContainer};
+use parser::hierarchy::music::MusicSwitchContainer;
 use poll_promise::Promise;
 use rayon::iter::{IntoParallelRefIterator, ParallelIterator};
 use std::sync::{Arc, Mutex};
 
 use crate::package_manager;
+use crate::package_manager::read_tag;
 use crate::util::format_file_size;
 
 use super::player::{BankData, PlayerView};
@@ -52,28 +53,20 @@ impl BankListView {
                 let all_banks = package_manager().get_all_by_type(26, Some(6));
                 let valid_hashes = mus_banks.clone();
                 all_banks.par_iter().for_each(|(th, _)| {
-                    let data = package_manager().read_tag(*th);
+                    let data = read_tag(*th);
                     if let Some(e) = data.as_ref().err() {
                         warn!("{}", e);
                         return;
                     }
                     let data = data.unwrap();
-                    let chunks = parser::parse(&data);
-                    // if let Some(e) = chunks.as_ref().err() {
-                    if chunks.as_ref().is_err() {
+                    // Only the object headers are needed to tell music banks apart.
+                    let Ok(bank) = parser::parse_borrowed(&data) else {
                         return;
-                    }
-                    let mut chunks = chunks.unwrap();
-                    let hirc = &mut chunks
-                        .iter_mut()
-                        .find_map(|c| {
-                            if let SoundbankChunkTypes::Hierarchy(hirc) = &c.chunk {
-                                return Some(hirc.clone());
-                            };
-                            None
-                        })
-                        .unwrap();
-                    if !hirc.get_all_by_type::<MusicSwitchContainer>().is_empty() {
+                    };
+                    if bank
+                        .hierarchy
+                        .is_some_and(|hirc| hirc.has_type::<MusicSwitchContainer>())
+                    {
                         valid_hashes.lock().unwrap().push(*th);
                     }
                 });
@@ -5,7 +5,8 @@ use eframe::egui::{Color32, Context, FontId, RichText, ScrollArea, SidePanel, Te
 use eframe::epaint::mutex::RwLock;
 use egui_dropdown::DropDownBox;
 use itertools::Itertools;
-use log::{info, trace};
+use log::{info, trace, warn};
+use parser::hierarchy::media::{MusicMediaGraph, SOUND_SOURCE_BANK};
 use parser::hierarchy::{HierarchyChunk, HierarchyObject};
 use parser::{
     SoundbankChunkTypes,
@@ -17,14 +18,15 @@ use parser::{
 use poll_promise::Promise;
 use rayon::iter::{IntoParallelRefMutIterator, ParallelIterator};
 use rrise::sound_engine::{clear_banks, load_bank_memory_view, stop_all, unregister_all_game_obj};
-use rrise::{AkCallbackInfo, AkCallbackType};
+use rrise::{AK_DEFAULT_PRIORITY, AkCallbackInfo, AkCallbackType, AkPriority};
 use rrise::{
-    AkCodecId, game_syncs,
+    AkCodecId, game_syncs, prefetch_manifest,
     sound_engine::{PostEvent, load_bank_memory_copy, render_audio},
     stream_mgr,
 };
 use std::sync::atomic::AtomicBool;
 use std::thread::JoinHandle;
+use std::time::Duration;
 use std::{
     fmt::Display,
     io::Write,
@@ -34,12 +36,16 @@ use std::{
     },
 };
 
-use crate::package_manager;
+use crate::{package_manager, package_manager::read_tag, prefetch};
 
 use super::{TOASTS, View, ViewAction, color, icons::*, style};
 
 pub const MUSIC_GROUP_ID: u32 = 1246133352;
 
+const MEDIA_PIN_PRIORITY: AkPriority = AK_DEFAULT_PRIORITY as AkPriority;
+/// Playback recorded into the bank's prefetch manifest after its first event is posted.
+const PREFETCH_RECORD_DURATION: Duration = Duration::from_secs(15);
+
 #[derive(Default, Debug)]
 pub struct BankData {
     pub id: u32,
@@ -51,6 +57,18 @@ pub struct BankData {
     // pub externals: Vec<AkExternalSourceInfo>,
     pub bank_data: Vec<Vec<u8>>,
     pub hierarchy: HierarchyChunk,
+    /// Streamed media of the bank's music tracks, pinned in the stream cache while the bank is
+    /// selected so switching between its segments doesn't wait on package reads.
+    pub pinned_media: Vec<u32>,
+    /// Streamed media reachable from each music node, to warm the files of a state before
+    /// switching to it.
+    pub media_graph: Arc<MusicMediaGraph>,
+}
+
+impl Drop for BankData {
+    fn drop(&mut self) {
+        stream_mgr::unpin_tiger_streamed_files(self.pinned_media.drain(..), MEDIA_PIN_PRIORITY);
+    }
 }
 
 #[derive(Copy, Clone)]
@@ -152,14 +170,14 @@ impl PlayerView {
     }
 
     pub fn create(tag: TagHash) -> Self {
-        let t = package_manager().read_tag(tag);
-        let tag_data = if t.is_err() {
-            let real_tags = package_manager().get_all_by_reference(tag.0);
-            let real_tag = real_tags.first().unwrap();
-            package_manager().read_tag(real_tag.0).ok().unwrap()
-        } else {
-            package_manager().read_tag(tag).ok().unwrap()
-        };
+        let tag_data = read_tag(tag)
+            .or_else(|_| {
+                let real_tags = package_manager().get_all_by_reference(tag.0);
+                let real_tag = real_tags.first().unwrap();
+                read_tag(real_tag.0)
+            })
+            .unwrap();
+        let tag_data = Arc::unwrap_or_clone(tag_data);
 
         let current_switch_id = Arc::new(AtomicU32::new(0));
         let switch_id = current_switch_id.clone();
@@ -254,6 +272,10 @@ impl View for PlayerView {
 
             self.current_switch_id
                 .store(first_switch, Ordering::Relaxed);
+            let data = self.bank_data.lock().unwrap();
+            if let Some(group) = data.main_switch.group_ids.first() {
+                prefetch::prefetch_switch(&data.media_graph, *group, first_switch);
+            }
 
             ctx.request_repaint();
         }
@@ -314,8 +336,14 @@ impl View for PlayerView {
                 TOASTS.lock().unwrap().error("Could not parse switch ID");
                 return None;
             }
-            self.current_switch_id
-                .store(val.unwrap(), Ordering::Relaxed);
+            let state = val.unwrap();
+            // The switch is applied on the next audio frame, start warming its files now.
+            prefetch::prefetch_switch(
+                &data.media_graph,
+                self.switch_group.load(Ordering::Relaxed),
+                state,
+            );
+            self.current_switch_id.store(state, Ordering::Relaxed);
         }
         let infos = self.callback_infos.clone();
         if change_event {
@@ -361,6 +389,8 @@ impl View for PlayerView {
                 })
             {
                 info!("Successfully started event with playingID {}", playing_id);
+                // Only the first event after the bank was loaded starts a recording.
+                prefetch_manifest::record_playback(PREFETCH_RECORD_DURATION);
             } else {
                 panic!("Couldn't post event");
             }
@@ -546,33 +576,43 @@ pub fn load_bank(data: &mut [u8]) -> anyhow::Result<BankData> {
     //         loaded_banks.push(id);
     //     }
     // }
-    let mut soundbank_sections = {
+    let soundbank_sections = {
         #[cfg(feature = "profiler")]
         profiling::scope!("soundbank parse");
         let data_len = data.len() as u32;
         bank_data.push(data.to_vec());
         let id = load_bank_memory_view(bank_data[0].as_mut_ptr() as *mut _, data_len)?;
         loaded_banks.push(id);
+        // Warm what the bank read the last time it played while its hierarchy is parsed.
+        prefetch_manifest::begin_bank(id);
 
         parser::parse(data)?
     };
 
     *BANK_PROGRESS.write() = BankStatus::ReadingHierarchy;
 
-    let hirc = &mut soundbank_sections
-        .iter_mut()
-        .find_map(|c| {
-            if let SoundbankChunkTypes::Hierarchy(hirc) = &c.chunk {
-                return Some(hirc.clone());
-            };
-            None
+    // Taken out of the sections rather than cloned, it ends up in BankData.
+    let hirc = soundbank_sections
+        .into_iter()
+        .find_map(|c| match c.chunk {
+            SoundbankChunkTypes::Hierarchy(hirc) => Some(hirc),
+            _ => None,
         })
-        .unwrap();
+        .ok_or_else(|| anyhow::anyhow!("No hierarchy chunk found in the bank"))?;
 
     // std::fs::write("temp/hirc.txt", format!("{:#?}", hirc))?;
 
     let tracks: Vec<MusicTrack> = hirc.get_all_by_type_cloned();
 
+    // Sources that aren't fully in the bank (prefetched or streamed) are read from the packages.
+    let streamed_media = tracks
+        .iter()
+        .flat_map(|t| &t.sounds)
+        .filter(|s| s.source != SOUND_SOURCE_BANK)
+        .map(|s| s.audio_id)
+        .unique()
+        .collect_vec();
+
     let play_actions =
         &hirc.filter_objects(|x: &EventAction| x.action_type == EventActionType::Play);
 
@@ -592,6 +632,9 @@ pub fn load_bank(data: &mut [u8]) -> anyhow::Result<BankData> {
     }
     let main_switch = main_switch.unwrap();
 
+    let media_graph = Arc::new(MusicMediaGraph::new(&hirc));
+    prefetch::prefetch_bank(&media_graph, main_switch.id);
+
     // let play_action = play_actions
     //     .iter()
     //     .filter(|x| x.object_id == main_switch.id)
@@ -700,6 +743,13 @@ pub fn load_bank(data: &mut [u8]) -> anyhow::Result<BankData> {
     // let mut externals = externals.lock().unwrap();
     // externals.dedup_by(|a, b| a.external_src_cookie == b.external_src_cookie);
 
+    // Pinned last: BankData unpins them on drop, nothing would on an early return.
+    let pinned_media = stream_mgr::pin_tiger_streamed_files(streamed_media, MEDIA_PIN_PRIORITY)
+        .unwrap_or_else(|e| {
+            warn!("Could not pin the bank's streamed media: {:?}", e);
+            vec![]
+        });
+
     info!("loaded {} banks", loaded_banks.len());
     // info!("loaded {} externals", externals.len());
     Ok(BankData {
@@ -709,6 +759,8 @@ pub fn load_bank(data: &mut [u8]) -> anyhow::Result<BankData> {
         stop_event_ids: stop_events.clone(),
         main_switch: main_switch.clone(),
         bank_data,
-        hierarchy: hirc.clone(),
+        hierarchy: hirc,
+        pinned_media,
+        media_graph,
     })
 }
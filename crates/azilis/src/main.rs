@@ -2,6 +2,7 @@
 mod config;
 mod gui;
 mod package_manager;
+mod prefetch;
 mod util;
 
 use anyhow::Result;
@@ -13,9 +14,9 @@ use env_logger::Env;
 use game_detector::InstalledGame;
 use gui::AzilisApp;
 use log::info;
-use package_manager::{initialize_package_manager, package_manager};
+use package_manager::{initialize_package_manager, package_manager, read_tag};
 use rrise::{
-    AkCallbackType, AkResult, memory_mgr, music_engine,
+    AkCallbackType, AkResult, memory_mgr, music_engine, prefetch_manifest,
     settings::{
         self, AkDeviceSettings, AkInitSettings, AkMemSettings, AkPlatformInitSettings,
         AkStreamMgrSettings,
@@ -136,7 +137,7 @@ fn main() -> Result<()> {
         let init_tags = package_manager().get_all_by_type(26, Some(5));
 
         {
-            let init_data = package_manager().read_tag(init_tags.first().unwrap().0)?;
+            let init_data = Arc::unwrap_or_clone(read_tag(init_tags.first().unwrap().0)?);
             let data_len = init_data.len() as u32;
             bank_data.push(init_data);
             let id = sound_engine::load_bank_memory_view(
@@ -288,7 +289,19 @@ fn init_sound_engine() -> Result<(), AkResult> {
     stream_mgr::init_tiger_stream_mgr(
         &AkStreamMgrSettings::default(),
         &mut AkDeviceSettings::default(),
+        stream_mgr::TigerIoScheduler::Deferred { workers: 4 },
+        false,
     )?;
+    // Keep music streams from queuing behind bank loads.
+    stream_mgr::add_tiger_stream_device(
+        stream_mgr::TigerDeviceClass::TigerDeviceClass_Streams,
+        &mut AkDeviceSettings::default(),
+    )?;
+    // Warm several streamed music files at once, see prefetch.
+    stream_mgr::set_tiger_file_prefetch_threads(4);
+    if let Some(pd) = directories::ProjectDirs::from("net", "nblock", "Azilis") {
+        prefetch_manifest::set_manifest_dir(pd.cache_dir().join("prefetch"));
+    }
 
     // let mut cc = sound_engine::AkChannelConfig::default();
     // cc.set_standard(rrise::AK_SPEAKER_SETUP_2_0);
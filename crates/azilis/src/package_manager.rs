@@ -1,4 +1,4 @@
-use destiny_pkg::PackageManager;
+use destiny_pkg::{PackageManager, TagHash};
 use eframe::epaint::mutex::RwLock;
 use lazy_static::lazy_static;
 use std::sync::Arc;
@@ -22,3 +22,9 @@ pub fn package_manager_checked() -> anyhow::Result<Arc<PackageManager>> {
 pub fn package_manager() -> Arc<PackageManager> {
     package_manager_checked().unwrap()
 }
+
+/// Reads `tag` from the package manager, sharing the read with the callers reading the same tag
+/// at the same time, see [rrise::package_manager::read_tag_shared].
+pub fn read_tag(tag: TagHash) -> anyhow::Result<Arc<Vec<u8>>> {
+    rrise::package_manager::read_tag_shared(&rrise::package_manager::package_index_checked()?, tag)
+}
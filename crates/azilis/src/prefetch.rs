@@ -0,0 +1,115 @@
+//! Warms the tiger file cache with the streamed media that music can reach next, so that starting
+//! a segment or switching state doesn't wait on package reads.
+
+use lazy_static::lazy_static;
+use log::{debug, trace};
+use parser::hierarchy::media::{MusicMediaGraph, TrackMedia};
+use rrise::{package_manager::wwise_file_by_reference, stream_mgr};
+use std::sync::{
+    Arc,
+    mpsc::{Receiver, Sender, channel},
+};
+
+/// Share of the file cache budget a whole bank may take, leaving room for the states switched to.
+const BANK_BUDGET_SHARE: f64 = 0.5;
+
+enum Request {
+    Bank {
+        graph: Arc<MusicMediaGraph>,
+        root: u32,
+    },
+    Switch {
+        graph: Arc<MusicMediaGraph>,
+        group: u32,
+        state: u32,
+    },
+}
+
+lazy_static! {
+    static ref REQUESTS: Sender<Request> = {
+        let (sender, receiver) = channel();
+        std::thread::Builder::new()
+            .name("music_prefetch".to_string())
+            .spawn(move || prefetch_thread(receiver))
+            .unwrap();
+        sender
+    };
+}
+
+/// Queues the media reachable from `root` (the bank's main music node) in the background, after
+/// any switch requested since.
+pub fn prefetch_bank(graph: &Arc<MusicMediaGraph>, root: u32) {
+    let _ = REQUESTS.send(Request::Bank {
+        graph: graph.clone(),
+        root,
+    });
+}
+
+/// Queues the media reachable from `state` of switch `group` ahead of everything else, for the
+/// state the music is about to switch to.
+pub fn prefetch_switch(graph: &Arc<MusicMediaGraph>, group: u32, state: u32) {
+    let _ = REQUESTS.send(Request::Switch {
+        graph: graph.clone(),
+        group,
+        state,
+    });
+}
+
+fn prefetch_thread(receiver: Receiver<Request>) {
+    #[cfg(feature = "profiler")]
+    profiling::register_thread!("music_prefetch");
+    while let Ok(request) = receiver.recv() {
+        // Only the latest of the switches requested meanwhile is worth warming first.
+        let mut requests = vec![request];
+        requests.extend(receiver.try_iter());
+        let last_switch = requests
+            .iter()
+            .rposition(|r| matches!(r, Request::Switch { .. }));
+
+        for (i, request) in requests.into_iter().enumerate() {
+            match request {
+                Request::Bank { graph, root } => {
+                    let media = graph.reachable_from(root);
+                    queue(&media, BANK_BUDGET_SHARE, false);
+                }
+                Request::Switch {
+                    graph,
+                    group,
+                    state,
+                } if Some(i) == last_switch => {
+                    let media = graph.reachable_from_switch(group, state);
+                    debug!(
+                        "Prefetching {} files for switch {group} state {state}",
+                        media.len()
+                    );
+                    queue(&media, 1.0, true);
+                }
+                Request::Switch { .. } => {}
+            }
+        }
+    }
+}
+
+/// Queues the most urgent files of `media` that fit in `budget_share` of the file cache budget.
+fn queue(media: &[TrackMedia], budget_share: f64, urgent: bool) {
+    let budget = (stream_mgr::tiger_file_cache_stats().uBudgetBytes as f64 * budget_share) as usize;
+    let mut total = 0;
+    let mut file_ids = vec![];
+    for m in media {
+        let Some((_, file)) = wwise_file_by_reference(m.audio_id) else {
+            continue;
+        };
+        if total + file.size > budget {
+            trace!(
+                "Prefetch budget of {budget} bytes reached after {} of {} files",
+                file_ids.len(),
+                media.len()
+            );
+            break;
+        }
+        total += file.size;
+        file_ids.push(m.audio_id);
+    }
+
+    stream_mgr::prefetch_tiger_files(&file_ids, urgent);
+}
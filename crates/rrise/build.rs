@@ -33,6 +33,30 @@ fn main() -> io::Result<()> {
     println!("cargo:rerun-if-changed=c/utilities/tiger_streaming_mgr.cpp");
     println!("cargo:rerun-if-changed=c/utilities/tiger_io_hook.h");
     println!("cargo:rerun-if-changed=c/utilities/tiger_io_hook.cpp");
+    println!("cargo:rerun-if-changed=c/utilities/tiger_io_hook_deferred.h");
+    println!("cargo:rerun-if-changed=c/utilities/tiger_io_hook_deferred.cpp");
+    println!("cargo:rerun-if-changed=c/utilities/tiger_file_cache.h");
+    println!("cargo:rerun-if-changed=c/utilities/tiger_file_cache.cpp");
+    println!("cargo:rerun-if-changed=c/utilities/tiger_buffer_pool.h");
+    println!("cargo:rerun-if-changed=c/utilities/tiger_buffer_pool.cpp");
+    println!("cargo:rerun-if-changed=c/utilities/tiger_io_uring.h");
+    println!("cargo:rerun-if-changed=c/utilities/tiger_io_uring.cpp");
+    println!("cargo:rerun-if-changed=c/utilities/tiger_io_stats.h");
+    println!("cargo:rerun-if-changed=c/utilities/tiger_io_stats.cpp");
+    println!("cargo:rerun-if-changed=c/utilities/tiger_layered_resolver.h");
+    println!("cargo:rerun-if-changed=c/utilities/tiger_layered_resolver.cpp");
+    println!("cargo:rerun-if-changed=c/utilities/tiger_device_router.h");
+    println!("cargo:rerun-if-changed=c/utilities/tiger_device_router.cpp");
+    println!("cargo:rerun-if-changed=c/utilities/tiger_write_behind.h");
+    println!("cargo:rerun-if-changed=c/utilities/tiger_write_behind.cpp");
+    println!("cargo:rerun-if-changed=c/utilities/tiger_fault_injector.h");
+    println!("cargo:rerun-if-changed=c/utilities/tiger_fault_injector.cpp");
+    println!("cargo:rerun-if-changed=c/utilities/tiger_stream_context.h");
+    println!("cargo:rerun-if-changed=c/utilities/tiger_stream_context.cpp");
+    println!("cargo:rerun-if-changed=c/utilities/tiger_package_file_table.h");
+    println!("cargo:rerun-if-changed=c/utilities/tiger_package_file_table.cpp");
+    println!("cargo:rerun-if-changed=c/utilities/tiger_read_recorder.h");
+    println!("cargo:rerun-if-changed=c/utilities/tiger_read_recorder.cpp");
     println!("cargo:rerun-if-env-changed=WWISESDK");
     println!("cargo:rerun-if-env-changed=RRISE_RERUN_BUILD");
     // --- END RERUN CONFIG
@@ -132,6 +156,18 @@ fn main() -> io::Result<()> {
     build
         .cpp(true)
         .file(crate_dir.join("tiger_io_hook.cpp"))
+        .file(crate_dir.join("tiger_io_hook_deferred.cpp"))
+        .file(crate_dir.join("tiger_file_cache.cpp"))
+        .file(crate_dir.join("tiger_buffer_pool.cpp"))
+        .file(crate_dir.join("tiger_io_uring.cpp"))
+        .file(crate_dir.join("tiger_io_stats.cpp"))
+        .file(crate_dir.join("tiger_layered_resolver.cpp"))
+        .file(crate_dir.join("tiger_device_router.cpp"))
+        .file(crate_dir.join("tiger_write_behind.cpp"))
+        .file(crate_dir.join("tiger_fault_injector.cpp"))
+        .file(crate_dir.join("tiger_stream_context.cpp"))
+        .file(crate_dir.join("tiger_package_file_table.cpp"))
+        .file(crate_dir.join("tiger_read_recorder.cpp"))
         .file(crate_dir.join("tiger_streaming_mgr.cpp"))
         .file(crate_dir.join("default_streaming_mgr.cpp"))
         .file(crate_dir.join("static_plugins.cpp"))
@@ -258,10 +294,60 @@ fn main() -> io::Result<()> {
         .allowlist_function("AddBasePath")
         .allowlist_function("TermDefaultStreamMgr")
         .allowlist_function("InitTigerStreamMgr")
+        .allowlist_function("InitTigerStreamMgrDeferred")
+        .allowlist_function("IsTigerIoUringActive")
+        .allowlist_function("AddTigerStreamDevice")
         .allowlist_function("TermTigerStreamMgr")
+        .allowlist_function("InitTigerLayeredResolver")
+        .allowlist_function("ClearTigerNegativeLookupCache")
+        .allowlist_function("GetTigerNegativeLookupHits")
+        .allowlist_function("InitTigerWriteBehind")
+        .allowlist_function("FlushTigerWriteBehind")
+        .allowlist_function("GetTigerWriteBehindStats")
+        .allowlist_function("OpenTigerStdStream")
+        .allowlist_function("ReadTigerStdStream")
+        .allowlist_function("CloseTigerStdStream")
+        .allowlist_function("CreateTigerStreamContext")
+        .allowlist_function("DestroyTigerStreamContext")
+        .allowlist_function("AddTigerContextStreamDevice")
+        .allowlist_function("OpenTigerContextStdStream")
+        .allowlist_function("SetTigerContextFileCacheBudget")
+        .allowlist_function("GetTigerContextFileCacheStats")
+        .allowlist_function("GetTigerContextIoStats")
+        .allowlist_function("SetTigerContextFaultProfile")
+        .allowlist_function("PinTigerStreamedFile")
+        .allowlist_function("UnpinTigerStreamedFile")
+        .allowlist_function("UpdateTigerStreamedFilePriority")
+        .allowlist_function("GetTigerPinnedFileStatus")
+        .allowlist_function("SetTigerFaultProfile")
+        .allowlist_function("SetTigerFaultSeed")
+        .allowlist_function("GetTigerFaultStats")
+        .allowlist_function("ResetTigerFaultStats")
+        .allowlist_function("RecordTigerMonitorError")
+        .allowlist_function("SetTigerFileCacheBudget")
+        .allowlist_function("GetTigerFileCacheStats")
+        .allowlist_function("PrefetchTigerFiles")
+        .allowlist_function("SetTigerFilePrefetchThreads")
+        .allowlist_function("StartTigerReadRecording")
+        .allowlist_function("StopTigerReadRecording")
+        .allowlist_function("GetTigerRecordedReads")
+        .allowlist_function("SetTigerBufferPoolMaxRetained")
+        .allowlist_function("GetTigerBufferPoolStats")
+        .allowlist_function("GetTigerIoStats")
+        .allowlist_function("ResetTigerIoStats")
+        .allowlist_function("SetTigerIoTraceLevel")
+        .allowlist_var("TIGER_IO_LATENCY_BUCKETS")
+        .allowlist_var("TIGER_DIRECT_IO_DEFAULT_ALIGNMENT")
+        .allowlist_var("TIGER_WRITE_BEHIND_DEFAULT_MAX_PENDING")
+        .allowlist_type("TigerIoTraceLevel")
+        .allowlist_type("TigerDeviceClass")
+        .allowlist_type("TigerFaultLatency")
         .blocklist_item("AK_INVALID_GAME_OBJECT")
         .blocklist_item("AK_INVALID_AUDIO_OBJECT_ID")
         .rustified_enum("AKRESULT")
+        .rustified_enum("TigerIoTraceLevel")
+        .rustified_enum("TigerDeviceClass")
+        .rustified_enum("TigerFaultLatency")
         .rustified_enum("AkGroupType")
         .rustified_enum("AkConnectionType")
         .rustified_enum("AkCurveInterpolation")
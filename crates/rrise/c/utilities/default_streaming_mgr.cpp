@@ -27,6 +27,16 @@ AKRESULT AddBasePath(const AkOSChar* in_pszBasePath)
 	return g_lowLevelIO.AddBasePath( in_pszBasePath );
 }
 
+AK::StreamMgr::IAkFileLocationResolver* GetDefaultStreamMgrResolver()
+{
+	return &g_lowLevelIO;
+}
+
+void TermDefaultStreamMgrDevice()
+{
+	g_lowLevelIO.Term();
+}
+
 void TermDefaultStreamMgr()
 {
 	g_lowLevelIO.Term();
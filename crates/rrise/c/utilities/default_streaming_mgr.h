@@ -12,4 +12,9 @@ AKRESULT SetBasePath(const AkOSChar* in_pszBasePath);
 AKRESULT AddBasePath(const AkOSChar* in_pszBasePath);
 void TermDefaultStreamMgr();
 
+// The default device as a File Location Resolver, for chaining it behind another one.
+AK::StreamMgr::IAkFileLocationResolver* GetDefaultStreamMgrResolver();
+// Terms the default device only, leaving the Stream Manager to its owner.
+void TermDefaultStreamMgrDevice();
+
 #endif // DEFAULT_STREAMING_MGR_H
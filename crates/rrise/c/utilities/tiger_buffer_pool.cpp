@@ -0,0 +1,101 @@
+#include <AK/SoundEngine/Common/AkMemoryMgr.h>
+#include "tiger_buffer_pool.h"
+
+void *TigerBufferPool::Allocate(size_t in_uSize)
+{
+    size_t uClass = SizeClass(in_uSize);
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_uAllocations++;
+        m_uBytesInUse += uClass;
+
+        auto it = m_freeLists.find(uClass);
+        if (it != m_freeLists.end() && !it->second.empty())
+        {
+            void *pBuffer = it->second.back();
+            it->second.pop_back();
+            m_uBytesRetained -= uClass;
+            m_uReuses++;
+            return pBuffer;
+        }
+
+        m_uHighWaterBytes = AkMax(m_uHighWaterBytes, m_uBytesInUse + m_uBytesRetained);
+    }
+
+    void *pBuffer = AkAlloc(AkMemID_Streaming, uClass);
+    if (!pBuffer)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_uBytesInUse -= uClass;
+    }
+    return pBuffer;
+}
+
+void TigerBufferPool::Free(void *in_pBuffer, size_t in_uSize)
+{
+    size_t uClass = SizeClass(in_uSize);
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_uBytesInUse -= uClass;
+        if (uClass <= TIGER_BUFFER_POOL_MAX_CLASS && m_uBytesRetained + uClass <= m_uMaxRetainedBytes)
+        {
+            m_freeLists[uClass].push_back(in_pBuffer);
+            m_uBytesRetained += uClass;
+            return;
+        }
+    }
+
+    AkFree(AkMemID_Streaming, in_pBuffer);
+}
+
+void TigerBufferPool::SetMaxRetained(size_t in_uMaxRetainedBytes)
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    m_uMaxRetainedBytes = in_uMaxRetainedBytes;
+    TrimTo(in_uMaxRetainedBytes);
+}
+
+void TigerBufferPool::GetStats(TigerBufferPoolStats &out_stats)
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    out_stats.uAllocations = m_uAllocations;
+    out_stats.uReuses = m_uReuses;
+    out_stats.uBytesInUse = m_uBytesInUse;
+    out_stats.uBytesRetained = m_uBytesRetained;
+    out_stats.uHighWaterBytes = m_uHighWaterBytes;
+    out_stats.uMaxRetainedBytes = m_uMaxRetainedBytes;
+}
+
+void TigerBufferPool::Trim()
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    TrimTo(0);
+}
+
+size_t TigerBufferPool::SizeClass(size_t in_uSize)
+{
+    if (in_uSize <= TIGER_BUFFER_POOL_MIN_CLASS)
+        return TIGER_BUFFER_POOL_MIN_CLASS;
+    if (in_uSize > TIGER_BUFFER_POOL_MAX_CLASS)
+        return in_uSize;
+
+    // in_uSize is in (uPow, 2 * uPow], split in four classes.
+    size_t uPow = TIGER_BUFFER_POOL_MIN_CLASS;
+    while (uPow * 2 < in_uSize)
+        uPow *= 2;
+    size_t uStep = uPow / 4;
+    return (in_uSize + uStep - 1) / uStep * uStep;
+}
+
+void TigerBufferPool::TrimTo(size_t in_uRetainedBytes)
+{
+    for (auto &freeList : m_freeLists)
+    {
+        while (m_uBytesRetained > in_uRetainedBytes && !freeList.second.empty())
+        {
+            AkFree(AkMemID_Streaming, freeList.second.back());
+            freeList.second.pop_back();
+            m_uBytesRetained -= freeList.first;
+        }
+    }
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <AK/SoundEngine/Common/AkTypes.h>
+
+// Smallest size class of TigerBufferPool, most media files are larger than this.
+#define TIGER_BUFFER_POOL_MIN_CLASS (16 * 1024)
+// Buffers larger than this are allocated and freed directly instead of being pooled.
+#define TIGER_BUFFER_POOL_MAX_CLASS (64 * 1024 * 1024)
+// Default amount of free memory the pool holds on to for reuse.
+#define TIGER_BUFFER_POOL_DEFAULT_RETAINED (32 * 1024 * 1024)
+
+// Counters exposed to Rust to size the pool for a given workload.
+struct TigerBufferPoolStats
+{
+    AkUInt64 uAllocations;       // Buffers handed out.
+    AkUInt64 uReuses;            // Buffers handed out from a free list, without allocating.
+    AkUInt64 uBytesInUse;        // Size class bytes of the buffers currently handed out.
+    AkUInt64 uBytesRetained;     // Free bytes held for reuse.
+    AkUInt64 uHighWaterBytes;    // Highest uBytesInUse + uBytesRetained seen so far.
+    AkUInt64 uMaxRetainedBytes;
+};
+
+// Size-class pool for the buffers package files are read into, backed by the Wwise memory manager
+// (AkMemID_Streaming).
+//
+// Sizes are rounded up to a class: classes double from TIGER_BUFFER_POOL_MIN_CLASS, with four
+// evenly spaced classes per doubling, so at most a quarter of a buffer is wasted. Freed buffers
+// are kept on per-class free lists, up to a retention budget, so opening and closing files of
+// similar sizes reuses the same memory.
+class TigerBufferPool
+{
+public:
+    TigerBufferPool() : m_uMaxRetainedBytes(TIGER_BUFFER_POOL_DEFAULT_RETAINED), m_uAllocations(0), m_uReuses(0), m_uBytesInUse(0), m_uBytesRetained(0), m_uHighWaterBytes(0) {}
+    ~TigerBufferPool() { Trim(); }
+
+    // Returns a buffer of at least in_uSize bytes, or NULL if out of memory.
+    void *Allocate(size_t in_uSize);
+    // Gives back a buffer returned by Allocate(in_uSize).
+    void Free(void *in_pBuffer, size_t in_uSize);
+
+    void SetMaxRetained(size_t in_uMaxRetainedBytes);
+    void GetStats(TigerBufferPoolStats &out_stats);
+
+    // Frees every retained buffer. Must be called before the memory manager is terminated.
+    void Trim();
+
+private:
+    static size_t SizeClass(size_t in_uSize);
+
+    void TrimTo(size_t in_uRetainedBytes);
+
+    std::mutex m_lock;
+    // Size class -> free buffers of that class.
+    std::unordered_map<size_t, std::vector<void *>> m_freeLists;
+
+    size_t m_uMaxRetainedBytes;
+    AkUInt64 m_uAllocations;
+    AkUInt64 m_uReuses;
+    size_t m_uBytesInUse;
+    size_t m_uBytesRetained;
+    size_t m_uHighWaterBytes;
+};
@@ -0,0 +1,73 @@
+#include "tiger_device_router.h"
+
+TigerDeviceRouter::TigerDeviceRouter()
+{
+    for (AkDeviceID &deviceID : m_deviceIDs)
+        deviceID = AK_INVALID_DEVICE_ID;
+    for (AkUInt32 &uGranularity : m_uGranularities)
+        uGranularity = 0;
+}
+
+AKRESULT TigerDeviceRouter::Init(const AkDeviceSettings &in_deviceSettings, AK::StreamMgr::IAkLowLevelIOHook *in_pHook)
+{
+    AkDeviceID deviceID = AK::StreamMgr::CreateDevice(in_deviceSettings, in_pHook);
+    if (deviceID == AK_INVALID_DEVICE_ID)
+        return AK_Fail;
+
+    for (int i = 0; i < TigerDeviceClass_Count; i++)
+    {
+        m_deviceIDs[i] = deviceID;
+        m_uGranularities[i] = in_deviceSettings.uGranularity;
+    }
+    return AK_Success;
+}
+
+AKRESULT TigerDeviceRouter::AddDevice(TigerDeviceClass in_eClass, const AkDeviceSettings &in_deviceSettings, AK::StreamMgr::IAkLowLevelIOHook *in_pHook)
+{
+    if (in_eClass <= TigerDeviceClass_Default || in_eClass >= TigerDeviceClass_Count)
+        return AK_InvalidParameter;
+    if (GetDefaultDevice() == AK_INVALID_DEVICE_ID || m_deviceIDs[in_eClass] != GetDefaultDevice())
+        return AK_Fail;
+
+    AkDeviceID deviceID = AK::StreamMgr::CreateDevice(in_deviceSettings, in_pHook);
+    if (deviceID == AK_INVALID_DEVICE_ID)
+        return AK_Fail;
+
+    m_deviceIDs[in_eClass] = deviceID;
+    m_uGranularities[in_eClass] = in_deviceSettings.uGranularity;
+    return AK_Success;
+}
+
+void TigerDeviceRouter::Term()
+{
+    // Dedicated devices first, the default one is shared by every class that has none.
+    for (int i = TigerDeviceClass_Count - 1; i >= 0; i--)
+    {
+        if (m_deviceIDs[i] != AK_INVALID_DEVICE_ID && (i == TigerDeviceClass_Default || m_deviceIDs[i] != GetDefaultDevice()))
+            AK::StreamMgr::DestroyDevice(m_deviceIDs[i]);
+    }
+
+    for (AkDeviceID &deviceID : m_deviceIDs)
+        deviceID = AK_INVALID_DEVICE_ID;
+}
+
+TigerDeviceClass TigerDeviceRouter::ClassOf(AkDeviceID in_deviceID) const
+{
+    for (int i = TigerDeviceClass_Default + 1; i < TigerDeviceClass_Count; i++)
+    {
+        if (m_deviceIDs[i] == in_deviceID && m_deviceIDs[i] != GetDefaultDevice())
+            return (TigerDeviceClass)i;
+    }
+    return TigerDeviceClass_Default;
+}
+
+TigerDeviceClass TigerDeviceRouter::Classify(const AkFileSystemFlags *in_pFlags)
+{
+    if (!in_pFlags)
+        return TigerDeviceClass_Default;
+    if (in_pFlags->uCompanyID == AKCOMPANYID_AUDIOKINETIC && in_pFlags->uCodecID == AKCODECID_BANK)
+        return TigerDeviceClass_Banks;
+    if (in_pFlags->bIsAutomaticStream)
+        return TigerDeviceClass_Streams;
+    return TigerDeviceClass_Default;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <AK/SoundEngine/Common/AkStreamMgrModule.h>
+
+// Classes of files that can be given a Stream Manager device of their own, so they don't compete
+// with the others for I/O memory and scheduling.
+enum TigerDeviceClass
+{
+    TigerDeviceClass_Default = 0, // Everything that is not routed to another device.
+    TigerDeviceClass_Banks = 1,   // Sound banks.
+    TigerDeviceClass_Streams = 2, // Streamed media (automatic streams), e.g. music tracks.
+    TigerDeviceClass_Count
+};
+
+// Stream Manager devices sharing one I/O hook, one per TigerDeviceClass. Files are routed to a
+// device at Open by their AkFileSystemFlags: classes without a device of their own fall back to
+// the default one.
+//
+// Devices are only added during initialization, before any file is opened, so routing doesn't
+// need a lock.
+class TigerDeviceRouter
+{
+public:
+    TigerDeviceRouter();
+
+    // Creates the default device, which must exist before the others are added.
+    AKRESULT Init(const AkDeviceSettings &in_deviceSettings, AK::StreamMgr::IAkLowLevelIOHook *in_pHook);
+
+    // Creates a dedicated device for in_eClass, with its own I/O memory, granularity and I/O
+    // thread. Fails if the class already has one.
+    AKRESULT AddDevice(TigerDeviceClass in_eClass, const AkDeviceSettings &in_deviceSettings, AK::StreamMgr::IAkLowLevelIOHook *in_pHook);
+
+    void Term();
+
+    AkDeviceID GetDefaultDevice() const { return m_deviceIDs[TigerDeviceClass_Default]; }
+    AkDeviceID GetDevice(TigerDeviceClass in_eClass) const { return m_deviceIDs[in_eClass]; }
+
+    // Granularity in_deviceID was created with, see ClassOf.
+    AkUInt32 GetGranularity(AkDeviceID in_deviceID) const { return m_uGranularities[ClassOf(in_deviceID)]; }
+
+    // Device serving the file opened with in_pFlags.
+    AkDeviceID Route(const AkFileSystemFlags *in_pFlags) const { return m_deviceIDs[Classify(in_pFlags)]; }
+
+    // The class that owns in_deviceID: the default class for the default device, which the
+    // classes without a device of their own share, and for unknown devices.
+    TigerDeviceClass ClassOf(AkDeviceID in_deviceID) const;
+
+    static TigerDeviceClass Classify(const AkFileSystemFlags *in_pFlags);
+
+private:
+    AkDeviceID m_deviceIDs[TigerDeviceClass_Count];
+    AkUInt32 m_uGranularities[TigerDeviceClass_Count];
+};
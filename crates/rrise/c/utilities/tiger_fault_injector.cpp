@@ -0,0 +1,173 @@
+#include <math.h>
+#include <string.h>
+#include <thread>
+#include "tiger_fault_injector.h"
+
+#define TIGER_FAULT_DEFAULT_SEED 0x9E3779B97F4A7C15ULL
+
+TigerFaultInjector::TigerFaultInjector() : m_bActive(false), m_uRandomState(TIGER_FAULT_DEFAULT_SEED), m_uFileClasses(0)
+{
+    memset(m_bHasProfile, 0, sizeof(m_bHasProfile));
+    memset(m_profiles, 0, sizeof(m_profiles));
+    memset(&m_stats, 0, sizeof(m_stats));
+}
+
+void TigerFaultInjector::SetProfile(TigerDeviceClass in_eClass, const TigerFaultProfile *in_pProfile)
+{
+    if (in_eClass < 0 || in_eClass >= TigerDeviceClass_Count)
+        return;
+
+    std::lock_guard<std::mutex> lock(m_lock);
+    m_bHasProfile[in_eClass] = in_pProfile != NULL;
+    if (in_pProfile)
+        m_profiles[in_eClass] = *in_pProfile;
+    m_pipeFreeAt[in_eClass] = Clock::time_point();
+
+    bool bActive = false;
+    for (int i = 0; i < TigerDeviceClass_Count; i++)
+        bActive |= m_bHasProfile[i];
+    m_bActive.store(bActive, std::memory_order_relaxed);
+}
+
+void TigerFaultInjector::SetSeed(AkUInt64 in_uSeed)
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    // xorshift never leaves 0.
+    m_uRandomState = in_uSeed ? in_uSeed : TIGER_FAULT_DEFAULT_SEED;
+}
+
+void TigerFaultInjector::OnOpen(const AkFileDesc &in_fileDesc, const AkFileSystemFlags *in_pFlags)
+{
+    // Opens stay off the lock unless faults are being injected.
+    if (!IsActive())
+        return;
+
+    std::lock_guard<std::mutex> lock(m_lock);
+    m_fileClasses[in_fileDesc.hFile] = TigerDeviceRouter::Classify(in_pFlags);
+    m_uFileClasses.store(m_fileClasses.size(), std::memory_order_relaxed);
+}
+
+void TigerFaultInjector::OnClose(const AkFileDesc &in_fileDesc)
+{
+    // Files opened while a profile was set are still forgotten once it is cleared.
+    if (m_uFileClasses.load(std::memory_order_relaxed) == 0)
+        return;
+
+    std::lock_guard<std::mutex> lock(m_lock);
+    m_fileClasses.erase(in_fileDesc.hFile);
+    m_uFileClasses.store(m_fileClasses.size(), std::memory_order_relaxed);
+}
+
+AKRESULT TigerFaultInjector::BeforeTransfer(const AkFileDesc &in_fileDesc, AkUInt32 in_uSize)
+{
+    if (!IsActive())
+        return AK_Success;
+
+    Clock::time_point now = Clock::now();
+    Clock::time_point releaseAt = now;
+    bool bFail = false;
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        auto it = m_fileClasses.find(in_fileDesc.hFile);
+        TigerDeviceClass eClass = it != m_fileClasses.end() ? it->second : TigerDeviceClass_Default;
+        if (!m_bHasProfile[eClass])
+            return AK_Success;
+
+        const TigerFaultProfile &profile = m_profiles[eClass];
+        m_stats.uTransfers++;
+
+        AkReal64 fDelayMs = DrawLatencyMs(profile);
+        if (profile.fSpikeProbability > 0.f && NextUniform() < profile.fSpikeProbability)
+        {
+            fDelayMs += profile.fSpikeMs;
+            m_stats.uSpikes++;
+        }
+        std::chrono::microseconds delay((AkInt64)(fDelayMs * 1000.0));
+        m_stats.uInjectedDelayUs += delay.count();
+        releaseAt += delay;
+
+        if (profile.uBandwidthBytesPerSec)
+        {
+            // The transfer enters the pipe once the previous one is through, and takes its size
+            // over the bandwidth to get out.
+            Clock::time_point start = AkMax(releaseAt, m_pipeFreeAt[eClass]);
+            std::chrono::microseconds duration(in_uSize * 1000000ULL / profile.uBandwidthBytesPerSec);
+            m_pipeFreeAt[eClass] = start + duration;
+            m_stats.uThrottledUs += std::chrono::duration_cast<std::chrono::microseconds>(m_pipeFreeAt[eClass] - releaseAt).count();
+            releaseAt = m_pipeFreeAt[eClass];
+        }
+
+        if (releaseAt > now)
+            m_stats.uDelayedTransfers++;
+
+        if (profile.fFailureProbability > 0.f && NextUniform() < profile.fFailureProbability)
+        {
+            bFail = true;
+            m_stats.uFailures++;
+        }
+    }
+
+    if (releaseAt > now)
+        std::this_thread::sleep_until(releaseAt);
+    return bFail ? AK_Fail : AK_Success;
+}
+
+bool TigerFaultInjector::RecordMonitorError(AK::Monitor::ErrorCode in_eErrorCode)
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    switch (in_eErrorCode)
+    {
+    case AK::Monitor::ErrorCode_StreamingSourceStarving:
+        m_stats.uStreamStarvations++;
+        return true;
+    case AK::Monitor::ErrorCode_VoiceStarving:
+        m_stats.uVoiceStarvations++;
+        return true;
+    case AK::Monitor::ErrorCode_TransitionNotAccurateStarvation:
+        m_stats.uTransitionStarvations++;
+        return true;
+    default:
+        return false;
+    }
+}
+
+void TigerFaultInjector::GetStats(TigerFaultStats &out_stats)
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    out_stats = m_stats;
+}
+
+void TigerFaultInjector::ResetStats()
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    memset(&m_stats, 0, sizeof(m_stats));
+}
+
+AkReal64 TigerFaultInjector::NextUniform()
+{
+    // xorshift64*, in [0, 1).
+    m_uRandomState ^= m_uRandomState >> 12;
+    m_uRandomState ^= m_uRandomState << 25;
+    m_uRandomState ^= m_uRandomState >> 27;
+    return (AkReal64)((m_uRandomState * 0x2545F4914F6CDD1DULL) >> 11) / (AkReal64)(1ULL << 53);
+}
+
+AkReal64 TigerFaultInjector::DrawLatencyMs(const TigerFaultProfile &in_profile)
+{
+    switch (in_profile.eLatency)
+    {
+    case TigerFaultLatency_Fixed:
+        return in_profile.fLatencyMs;
+    case TigerFaultLatency_Uniform:
+        return in_profile.fLatencyMs + NextUniform() * AkMax(in_profile.fLatencyMaxMs - in_profile.fLatencyMs, 0.f);
+    case TigerFaultLatency_Exponential:
+    {
+        AkReal64 fLatencyMs = -log(1.0 - NextUniform()) * in_profile.fLatencyMs;
+        if (in_profile.fLatencyMaxMs > 0.f)
+            fLatencyMs = AkMin(fLatencyMs, (AkReal64)in_profile.fLatencyMaxMs);
+        return fLatencyMs;
+    }
+    default:
+        return 0.0;
+    }
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <unordered_map>
+#include <AK/SoundEngine/Common/AkStreamMgrModule.h>
+#include <AK/Tools/Common/AkMonitorError.h>
+#include "tiger_device_router.h"
+
+// Shape of the latency added to each transfer of a class of files.
+enum TigerFaultLatency
+{
+    TigerFaultLatency_None = 0,        // No added latency.
+    TigerFaultLatency_Fixed = 1,       // Always fLatencyMs.
+    TigerFaultLatency_Uniform = 2,     // Uniform between fLatencyMs and fLatencyMaxMs.
+    TigerFaultLatency_Exponential = 3, // Exponential of mean fLatencyMs, capped at fLatencyMaxMs (if not 0).
+};
+
+// Faults injected into the transfers of one TigerDeviceClass. A zeroed profile injects nothing.
+struct TigerFaultProfile
+{
+    AkUInt32 eLatency; // TigerFaultLatency.
+    AkReal32 fLatencyMs;
+    AkReal32 fLatencyMaxMs;
+    // Chance that a transfer is held for another fSpikeMs, on top of its latency: the occasional
+    // seek storm or contending process of a busy disk.
+    AkReal32 fSpikeProbability;
+    AkReal32 fSpikeMs;
+    // Throughput of the class as a whole, 0 for none. Transfers of the class are serialized
+    // through a virtual pipe of this many bytes per second.
+    AkUInt64 uBandwidthBytesPerSec;
+    // Chance that a transfer fails with AK_Fail. The Stream Manager treats it like a read error of
+    // the device: the stream it belongs to stops.
+    AkReal32 fFailureProbability;
+};
+
+// Counters of TigerFaultInjector, and of the starvation the engine reported meanwhile.
+struct TigerFaultStats
+{
+    AkUInt64 uTransfers;        // Transfers of classes with a profile.
+    AkUInt64 uDelayedTransfers; // Transfers that were held for any time.
+    AkUInt64 uSpikes;
+    AkUInt64 uFailures;
+    AkUInt64 uInjectedDelayUs;  // Total latency and spikes added.
+    AkUInt64 uThrottledUs;      // Total time transfers waited for the bandwidth cap.
+    AkUInt64 uStreamStarvations;     // ErrorCode_StreamingSourceStarving reports.
+    AkUInt64 uVoiceStarvations;      // ErrorCode_VoiceStarving reports.
+    AkUInt64 uTransitionStarvations; // ErrorCode_TransitionNotAccurateStarvation reports.
+};
+
+// Injects latency, bandwidth caps and failures into the transfers of TigerPackageIo, per
+// TigerDeviceClass, to reproduce disk contention on demand. Transfers are held on the thread
+// issuing them (the Stream Manager's I/O thread, or a worker of TigerPackageIoDeferred), exactly
+// like a slow device would hold them.
+//
+// Draws come from one generator seeded by SetSeed, so a given seed replays the same sequence of
+// faults (their assignment to transfers still depends on thread scheduling with several workers).
+//
+// Starvation the engine reports through its monitoring callback is counted alongside, see
+// RecordMonitorError, so buffering and prefetch settings can be checked against the faults.
+class TigerFaultInjector
+{
+public:
+    TigerFaultInjector();
+
+    // Replaces the profile of in_eClass, NULL to stop injecting faults into it.
+    void SetProfile(TigerDeviceClass in_eClass, const TigerFaultProfile *in_pProfile);
+    void SetSeed(AkUInt64 in_uSeed);
+
+    // Remembers the class of a file opened with in_pFlags, until OnClose. Only files opened while
+    // a profile is set are remembered, the others count as TigerDeviceClass_Default: profiles are
+    // best set before the files they target are opened.
+    void OnOpen(const AkFileDesc &in_fileDesc, const AkFileSystemFlags *in_pFlags);
+    void OnClose(const AkFileDesc &in_fileDesc);
+
+    // Called before a transfer of in_uSize bytes of in_fileDesc: blocks for the injected latency
+    // and returns AK_Fail when the transfer must fail.
+    AKRESULT BeforeTransfer(const AkFileDesc &in_fileDesc, AkUInt32 in_uSize);
+
+    bool IsActive() const { return m_bActive.load(std::memory_order_relaxed); }
+
+    // Counts in_eErrorCode if it reports starvation, and returns whether it did.
+    bool RecordMonitorError(AK::Monitor::ErrorCode in_eErrorCode);
+
+    void GetStats(TigerFaultStats &out_stats);
+    void ResetStats();
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    // m_lock must be held.
+    AkReal64 NextUniform();
+    AkReal64 DrawLatencyMs(const TigerFaultProfile &in_profile);
+
+    std::mutex m_lock;
+    // Lets transfers skip the lock entirely while no profile is set.
+    std::atomic<bool> m_bActive;
+    bool m_bHasProfile[TigerDeviceClass_Count];
+    TigerFaultProfile m_profiles[TigerDeviceClass_Count];
+    // End of the last transfer admitted through the bandwidth cap of each class.
+    Clock::time_point m_pipeFreeAt[TigerDeviceClass_Count];
+    AkUInt64 m_uRandomState;
+    // File handle -> class, of the files open.
+    std::unordered_map<AkFileHandle, TigerDeviceClass> m_fileClasses;
+    // Size of m_fileClasses, for OnClose to skip the lock when it is empty.
+    std::atomic<size_t> m_uFileClasses;
+    TigerFaultStats m_stats;
+};
@@ -0,0 +1,325 @@
+#include <algorithm>
+#include "tiger_file_cache.h"
+
+extern "C"
+{
+    // source is the file source of the hook (see TigerPackageIo::SetFileSource), NULL for the
+    // process-wide one.
+    size_t ddumbe_get_wwise_file_size_by_id(const void *source, uint32_t id);
+    AKRESULT ddumbe_read_wwise_file_range_by_id(const void *source, uint32_t id, uint64_t offset, void *buffer, size_t size);
+}
+
+AKRESULT TigerFileCache::Acquire(AkFileID in_fileID, TigerFileBuffer &out_buffer)
+{
+    std::unique_lock<std::mutex> lock(m_lock);
+    if (m_loading.count(in_fileID))
+    {
+        auto queued = std::find(m_prefetchQueue.begin(), m_prefetchQueue.end(), in_fileID);
+        if (queued != m_prefetchQueue.end())
+        {
+            // Not picked up by the background thread yet, fetch it here rather than wait behind
+            // the rest of the queue. It stays in m_loading, now on behalf of this thread.
+            m_prefetchQueue.erase(queued);
+            m_uMisses++;
+            TakeReservation(in_fileID);
+            return Fetch(lock, in_fileID, true, out_buffer);
+        }
+
+        m_loadSignal.wait(lock, [this, in_fileID]
+                          { return m_loading.count(in_fileID) == 0; });
+    }
+
+    auto it = m_entries.find(in_fileID);
+    if (it != m_entries.end())
+    {
+        Entry &entry = it->second;
+        // A reservation already holds a reference, it becomes this one.
+        if (!TakeReservation(in_fileID) && entry.uRefCount++ == 0)
+            m_lru.erase(entry.lruIt);
+        m_uHits++;
+        out_buffer = entry.buffer;
+        return AK_Success;
+    }
+
+    m_uMisses++;
+    m_loading.insert(in_fileID);
+    TakeReservation(in_fileID);
+    return Fetch(lock, in_fileID, true, out_buffer);
+}
+
+AKRESULT TigerFileCache::Fetch(std::unique_lock<std::mutex> &io_lock, AkFileID in_fileID, bool in_bAcquire, TigerFileBuffer &out_buffer)
+{
+    // Fetch outside of the lock, this is where the package read and decompression happen.
+    io_lock.unlock();
+    TigerFileBuffer buffer = {};
+    AKRESULT eResult = ReadWholeFile(in_fileID, buffer);
+    io_lock.lock();
+
+    m_loading.erase(in_fileID);
+    m_loadSignal.notify_all();
+    if (eResult != AK_Success)
+        return eResult;
+
+    Entry &entry = m_entries[in_fileID];
+    entry.buffer = buffer;
+    entry.uRefCount = in_bAcquire ? 1 : 0;
+    auto reserved = m_reservations.find(in_fileID);
+    if (reserved != m_reservations.end())
+        entry.uRefCount += reserved->second;
+    if (entry.uRefCount == 0)
+    {
+        m_lru.push_front(in_fileID);
+        entry.lruIt = m_lru.begin();
+    }
+    m_uResidentBytes += buffer.size;
+    out_buffer = buffer;
+
+    EvictOverBudget();
+    return AK_Success;
+}
+
+AKRESULT TigerFileCache::ReadWholeFile(AkFileID in_fileID, TigerFileBuffer &out_buffer)
+{
+    size_t uSize = ddumbe_get_wwise_file_size_by_id(m_pFileSource, in_fileID);
+    if (uSize == SIZE_MAX)
+        return AK_FileNotFound;
+
+    // The file is read block by block straight into the pooled buffer, no intermediate copy of
+    // the whole file is made on the package side.
+    uint8_t *pData = (uint8_t *)m_pool.Allocate(uSize);
+    if (!pData)
+        return AK_InsufficientMemory;
+
+    AKRESULT eResult = ddumbe_read_wwise_file_range_by_id(m_pFileSource, in_fileID, 0, pData, uSize);
+    if (eResult != AK_Success)
+    {
+        m_pool.Free(pData, uSize);
+        return eResult;
+    }
+
+    out_buffer.data = pData;
+    out_buffer.size = uSize;
+    return AK_Success;
+}
+
+void TigerFileCache::Release(AkFileID in_fileID)
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    auto it = m_entries.find(in_fileID);
+    AKASSERT(it != m_entries.end() && it->second.uRefCount > 0);
+    if (it == m_entries.end() || it->second.uRefCount == 0)
+        return;
+
+    Entry &entry = it->second;
+    if (--entry.uRefCount == 0)
+    {
+        m_lru.push_front(in_fileID);
+        entry.lruIt = m_lru.begin();
+        EvictOverBudget();
+    }
+}
+
+bool TigerFileCache::TryAcquire(AkFileID in_fileID, TigerFileBuffer &out_buffer)
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    auto it = m_entries.find(in_fileID);
+    if (it == m_entries.end())
+        return false;
+
+    Entry &entry = it->second;
+    if (entry.uRefCount++ == 0)
+        m_lru.erase(entry.lruIt);
+    m_uHits++;
+    out_buffer = entry.buffer;
+    return true;
+}
+
+void TigerFileCache::Prefetch(AkFileID in_fileID, bool in_bUrgent)
+{
+    bool bQueued;
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        bQueued = QueuePrefetch(in_fileID, in_bUrgent);
+    }
+    if (bQueued)
+        m_prefetchSignal.notify_one();
+}
+
+void TigerFileCache::PrefetchReserved(AkFileID in_fileID)
+{
+    bool bQueued = false;
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_reservations[in_fileID]++;
+        auto it = m_entries.find(in_fileID);
+        if (it != m_entries.end())
+        {
+            Entry &entry = it->second;
+            if (entry.uRefCount++ == 0)
+                m_lru.erase(entry.lruIt);
+        }
+        else
+        {
+            // Fetch adds the reservation's reference once the file is resident.
+            bQueued = QueuePrefetch(in_fileID, false);
+        }
+    }
+    if (bQueued)
+        m_prefetchSignal.notify_one();
+}
+
+bool TigerFileCache::QueuePrefetch(AkFileID in_fileID, bool in_bUrgent)
+{
+    // Clear is stopping the threads, they would never pick the file up.
+    if (m_bStopPrefetch || m_entries.count(in_fileID))
+        return false;
+
+    if (m_loading.count(in_fileID))
+    {
+        // Either in flight or queued. Only a queued file can still be moved up.
+        auto queued = std::find(m_prefetchQueue.begin(), m_prefetchQueue.end(), in_fileID);
+        if (!in_bUrgent || queued == m_prefetchQueue.end())
+            return false;
+        m_prefetchQueue.erase(queued);
+    }
+    else
+    {
+        m_loading.insert(in_fileID);
+    }
+
+    if (in_bUrgent)
+        m_prefetchQueue.push_front(in_fileID);
+    else
+        m_prefetchQueue.push_back(in_fileID);
+
+    // Another thread whenever the queue outgrows the threads there are, up to the count.
+    if (m_prefetchThreads.size() < m_uPrefetchThreads && m_prefetchQueue.size() > m_prefetchThreads.size())
+        m_prefetchThreads.emplace_back(&TigerFileCache::PrefetchMain, this);
+    return true;
+}
+
+bool TigerFileCache::TakeReservation(AkFileID in_fileID)
+{
+    auto it = m_reservations.find(in_fileID);
+    if (it == m_reservations.end())
+        return false;
+    if (--it->second == 0)
+        m_reservations.erase(it);
+    return true;
+}
+
+void TigerFileCache::SetPrefetchThreads(AkUInt32 in_uCount)
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    m_uPrefetchThreads = std::max(in_uCount, 1u);
+}
+
+void TigerFileCache::PrefetchMain()
+{
+    std::unique_lock<std::mutex> lock(m_lock);
+    for (;;)
+    {
+        m_prefetchSignal.wait(lock, [this]
+                              { return m_bStopPrefetch || !m_prefetchQueue.empty(); });
+        if (m_bStopPrefetch)
+            return;
+
+        AkFileID fileID = m_prefetchQueue.front();
+        m_prefetchQueue.pop_front();
+        m_uPrefetches++;
+
+        TigerFileBuffer buffer;
+        Fetch(lock, fileID, false, buffer);
+    }
+}
+
+void TigerFileCache::StopPrefetch()
+{
+    // Joined outside of the lock, which the threads need to exit. Prefetch doesn't start threads
+    // while they stop, the vector is taken out anyway so nothing can touch the ones joined.
+    std::vector<std::thread> threads;
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_bStopPrefetch = true;
+        for (AkFileID fileID : m_prefetchQueue)
+            m_loading.erase(fileID);
+        m_prefetchQueue.clear();
+        std::swap(threads, m_prefetchThreads);
+    }
+    m_prefetchSignal.notify_all();
+    m_loadSignal.notify_all();
+
+    for (std::thread &thread : threads)
+        thread.join();
+
+    std::lock_guard<std::mutex> lock(m_lock);
+    m_bStopPrefetch = false;
+}
+
+void TigerFileCache::SetBudget(size_t in_uBudgetBytes)
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    m_uBudgetBytes = in_uBudgetBytes;
+    EvictOverBudget();
+}
+
+void TigerFileCache::GetStats(TigerFileCacheStats &out_stats)
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    out_stats.uHits = m_uHits;
+    out_stats.uMisses = m_uMisses;
+    out_stats.uPrefetches = m_uPrefetches;
+    out_stats.uEvictions = m_uEvictions;
+    out_stats.uResidentBytes = m_uResidentBytes;
+    out_stats.uBudgetBytes = m_uBudgetBytes;
+}
+
+void TigerFileCache::Clear()
+{
+    StopPrefetch();
+
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        // Opens that never came back for their file.
+        for (auto &reservation : m_reservations)
+        {
+            auto it = m_entries.find(reservation.first);
+            if (it == m_entries.end())
+                continue;
+            Entry &entry = it->second;
+            entry.uRefCount -= reservation.second;
+            if (entry.uRefCount == 0)
+            {
+                m_lru.push_front(reservation.first);
+                entry.lruIt = m_lru.begin();
+            }
+        }
+        m_reservations.clear();
+
+        while (!m_lru.empty())
+            Evict(std::prev(m_lru.end()));
+    }
+    m_pool.Trim();
+}
+
+void TigerFileCache::EvictOverBudget()
+{
+    // Files that are still open are never evicted, so the resident size may stay over budget
+    // until they are closed.
+    while (m_uResidentBytes > m_uBudgetBytes && !m_lru.empty())
+    {
+        Evict(std::prev(m_lru.end()));
+        m_uEvictions++;
+    }
+}
+
+void TigerFileCache::Evict(std::list<AkFileID>::iterator in_lruIt)
+{
+    auto it = m_entries.find(*in_lruIt);
+    m_lru.erase(in_lruIt);
+
+    TigerFileBuffer &buffer = it->second.buffer;
+    m_uResidentBytes -= buffer.size;
+    m_pool.Free((void *)buffer.data, buffer.size);
+    m_entries.erase(it);
+}
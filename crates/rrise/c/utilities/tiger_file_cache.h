@@ -0,0 +1,134 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <AK/SoundEngine/Common/AkTypes.h>
+#include "tiger_buffer_pool.h"
+
+// A whole package file, read into a buffer of the cache's TigerBufferPool.
+struct TigerFileBuffer
+{
+    const uint8_t *data;
+    size_t size;
+};
+
+// Counters exposed to Rust to size the cache for a given workload.
+struct TigerFileCacheStats
+{
+    AkUInt64 uHits;
+    AkUInt64 uMisses;
+    // Files fetched in the background, see Prefetch. Neither hits nor misses.
+    AkUInt64 uPrefetches;
+    AkUInt64 uEvictions;
+    AkUInt64 uResidentBytes;
+    AkUInt64 uBudgetBytes;
+};
+
+// Size-bounded LRU cache of package-resolved Wwise files, keyed by AkFileID.
+//
+// Buffers are reference counted: a file stays resident while it is open, and is only considered
+// for eviction once its last user released it. Unreferenced files are evicted, least recently
+// used first, whenever the resident size exceeds the budget.
+//
+// A file is only ever fetched once at a time: Acquire waits for a fetch of the same file that is
+// already in flight, including one started by Prefetch on the background thread.
+class TigerFileCache
+{
+public:
+    explicit TigerFileCache(size_t in_uBudgetBytes) : m_pFileSource(NULL), m_uPrefetchThreads(1), m_bStopPrefetch(false), m_uBudgetBytes(in_uBudgetBytes), m_uResidentBytes(0), m_uHits(0), m_uMisses(0), m_uPrefetches(0), m_uEvictions(0) {}
+    ~TigerFileCache() { Clear(); }
+
+    // Returns the buffer holding in_fileID, fetching it from the package manager on a miss.
+    // Every successful Acquire must be paired with a Release.
+    AKRESULT Acquire(AkFileID in_fileID, TigerFileBuffer &out_buffer);
+    void Release(AkFileID in_fileID);
+
+    // Acquires in_fileID only if it is resident already, without fetching it or waiting for a
+    // fetch in flight. Streamed files are served from the cache this way when they were prefetched.
+    bool TryAcquire(AkFileID in_fileID, TigerFileBuffer &out_buffer);
+
+    // Queues in_fileID to be fetched on the cache's background threads, unless it is already
+    // resident or being fetched. The file then stays resident, unreferenced, until evicted.
+    // Urgent files go ahead of the queue, including when they were queued before.
+    void Prefetch(AkFileID in_fileID, bool in_bUrgent);
+
+    // Prefetches in_fileID for an open that will Acquire it shortly, holding a reference on its
+    // behalf so it can't be evicted in between, whatever the budget. The next Acquire of the file
+    // takes that reference over. Reservations left are dropped by Clear.
+    void PrefetchReserved(AkFileID in_fileID);
+
+    // Number of background threads fetching prefetched files, 1 by default. Threads are started
+    // as files are queued; lowering the count only stops the extra ones on Clear.
+    void SetPrefetchThreads(AkUInt32 in_uCount);
+
+    void SetBudget(size_t in_uBudgetBytes);
+    void GetStats(TigerFileCacheStats &out_stats);
+
+    TigerBufferPool &GetBufferPool() { return m_pool; }
+
+    // Where files are fetched from, see TigerPackageIo::SetFileSource.
+    void SetFileSource(const void *in_pFileSource) { m_pFileSource = in_pFileSource; }
+
+    // Stops the background threads, dropping pending prefetches and those requested meanwhile,
+    // drops every unreferenced file and frees the memory retained by the buffer pool.
+    void Clear();
+
+private:
+    struct Entry
+    {
+        TigerFileBuffer buffer;
+        AkUInt32 uRefCount;
+        // Position in m_lru, only valid while uRefCount is 0.
+        std::list<AkFileID>::iterator lruIt;
+    };
+
+    // Fetches in_fileID, which the caller must have added to m_loading. io_lock is released
+    // during the fetch. The new entry starts with one reference per reservation of the file, plus
+    // one when in_bAcquire is set.
+    AKRESULT Fetch(std::unique_lock<std::mutex> &io_lock, AkFileID in_fileID, bool in_bAcquire, TigerFileBuffer &out_buffer);
+    AKRESULT ReadWholeFile(AkFileID in_fileID, TigerFileBuffer &out_buffer);
+    // Queues in_fileID under m_lock, see Prefetch. Returns whether a thread should be woken up.
+    bool QueuePrefetch(AkFileID in_fileID, bool in_bUrgent);
+    // Takes over a reservation of in_fileID, see PrefetchReserved.
+    bool TakeReservation(AkFileID in_fileID);
+    void PrefetchMain();
+    void StopPrefetch();
+
+    void EvictOverBudget();
+    void Evict(std::list<AkFileID>::iterator in_lruIt);
+
+    TigerBufferPool m_pool;
+    const void *m_pFileSource;
+
+    std::mutex m_lock;
+    std::unordered_map<AkFileID, Entry> m_entries;
+    // Unreferenced files, most recently released first.
+    std::list<AkFileID> m_lru;
+
+    // Files being fetched, or queued in m_prefetchQueue.
+    std::unordered_set<AkFileID> m_loading;
+    std::condition_variable m_loadSignal;
+
+    // Opens waiting to Acquire a file, see PrefetchReserved. Each holds a reference to the entry
+    // once the file is resident.
+    std::unordered_map<AkFileID, AkUInt32> m_reservations;
+
+    std::vector<std::thread> m_prefetchThreads;
+    AkUInt32 m_uPrefetchThreads;
+    std::deque<AkFileID> m_prefetchQueue;
+    std::condition_variable m_prefetchSignal;
+    bool m_bStopPrefetch;
+
+    size_t m_uBudgetBytes;
+    size_t m_uResidentBytes;
+    AkUInt64 m_uHits;
+    AkUInt64 m_uMisses;
+    AkUInt64 m_uPrefetches;
+    AkUInt64 m_uEvictions;
+};
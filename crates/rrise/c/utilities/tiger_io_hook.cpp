@@ -1,13 +1,62 @@
 #include <AkFileHelpers.h>
 #include "tiger_io_hook.h"
 
+#if !defined(AK_WIN)
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 extern "C"
 {
-    size_t ddumbe_get_wwise_file_size_by_id(uint32_t id);
-    AKRESULT ddumbe_read_wwise_file_by_id(uint32_t id, void *buffer, size_t size);
+    // source is the file source of the hook (see TigerPackageIo::SetFileSource), NULL for the
+    // process-wide one.
+    size_t ddumbe_get_wwise_file_size_by_id(const void *source, uint32_t id);
+    uint32_t ddumbe_get_wwise_file_block_size_by_id(const void *source, uint32_t id);
+    AKRESULT ddumbe_read_wwise_file_range_by_id(const void *source, uint32_t id, uint64_t offset, void *buffer, size_t size);
 }
 
-#define FILE_HANDLE_PACKAGE_BIT (1 << 31)
+// Package files are handles of TigerPackageFileTable with this bit set. Loose file handles (POSIX
+// descriptors, Win32 handles) never have it.
+#define FILE_HANDLE_PACKAGE_BIT (1ULL << 63)
+static_assert(sizeof(AkFileHandle) >= sizeof(AkUInt64), "package file handles need 64 bits");
+
+#if !defined(AK_WIN)
+// Loose files are plain POSIX descriptors, stored as-is in AkFileDesc::hFile.
+#define FILE_HANDLE_TO_FD(h) ((int)(intptr_t)(h))
+#define FD_TO_FILE_HANDLE(fd) ((AkFileHandle)(intptr_t)(fd))
+
+// Transfers whose deadline is closer than this get the next window of the file prefetched by the
+// kernel, so the following request of a starving stream is already in the page cache.
+#define WILLNEED_DEADLINE_MS 100.f
+
+// Reads at least in_uMin and at most in_uMax bytes at in_offset, stopping early only at end of file.
+static AKRESULT PreadAtLeast(int in_fd, uint8_t *out_pDst, size_t in_uMax, size_t in_uMin, off_t in_offset)
+{
+    size_t uDone = 0;
+    while (uDone < in_uMin)
+    {
+        ssize_t uRead = ::pread(in_fd, out_pDst + uDone, in_uMax - uDone, in_offset + uDone);
+        if (uRead < 0 && errno == EINTR)
+            continue;
+        if (uRead <= 0)
+            return AK_Fail;
+        uDone += uRead;
+    }
+    return AK_Success;
+}
+
+static AkUInt32 QueryDirectIOAlignment(int in_fd)
+{
+#if defined(STATX_DIOALIGN)
+    struct statx stx;
+    if (::statx(in_fd, "", AT_EMPTY_PATH, STATX_DIOALIGN, &stx) == 0 && (stx.stx_mask & STATX_DIOALIGN) && stx.stx_dio_offset_align)
+        return AkMax(stx.stx_dio_offset_align, stx.stx_dio_mem_align);
+#endif
+    return TIGER_DIRECT_IO_DEFAULT_ALIGNMENT;
+}
+#endif
 
 AKRESULT TigerPackageIo::Init(const AkDeviceSettings &in_deviceSettings)
 {
@@ -23,18 +72,35 @@ AKRESULT TigerPackageIo::Init(const AkDeviceSettings &in_deviceSettings)
         AK::StreamMgr::SetFileLocationResolver(this);
 
     // Create a device in the Stream Manager, specifying this as the hook.
-    m_deviceID = AK::StreamMgr::CreateDevice(in_deviceSettings, this);
-    if (m_deviceID != AK_INVALID_DEVICE_ID)
-        return AK_Success;
+    return m_devices.Init(in_deviceSettings, this);
+}
 
-    return AK_Success;
+AKRESULT TigerPackageIo::AddDevice(TigerDeviceClass in_eClass, const AkDeviceSettings &in_deviceSettings)
+{
+    if (in_deviceSettings.uSchedulerTypeFlags != AK_SCHEDULER_BLOCKING)
+        return AK_InvalidParameter;
+
+    return m_devices.AddDevice(in_eClass, in_deviceSettings, this);
 }
 
 void TigerPackageIo::Term()
 {
     if (AK::StreamMgr::GetFileLocationResolver() == this)
         AK::StreamMgr::SetFileLocationResolver(NULL);
-    AK::StreamMgr::DestroyDevice(m_deviceID);
+    m_devices.Term();
+    m_fileCache.Clear();
+}
+
+void TigerPackageIo::GetIoStats(TigerDeviceClass in_eClass, TigerIoDeviceStats &out_stats)
+{
+    AkDeviceID deviceID = m_pRouter->GetDevice(in_eClass);
+    GetIoCounters(deviceID).Snapshot(deviceID, out_stats);
+}
+
+void TigerPackageIo::ResetIoStats()
+{
+    for (TigerIoCounters &counters : m_ioCounters)
+        counters.Reset();
 }
 
 AKRESULT TigerPackageIo::Open(
@@ -45,7 +111,24 @@ AKRESULT TigerPackageIo::Open(
     AkFileDesc &out_fileDesc        ///< Returned file descriptor.
 )
 {
-    wprintf(L"Open('%s', cacheid=%08X)\n", in_pszFileName, in_pFlags->uCacheID);
+    TigerIoTimer timer;
+    AKRESULT eResult = OpenLooseFile(in_pszFileName, in_eOpenMode, in_pFlags, out_fileDesc);
+    // Failed opens have no descriptor, they count against the device they would have used.
+    GetIoCounters(m_pRouter->Route(in_pFlags)).RecordOpen(eResult, timer.ElapsedUs());
+
+    if (eResult == AK_Success)
+        TIGER_IO_TRACE(TigerIoTraceLevel_Files, "Open('" TIGER_IO_OSCHAR_FMT "') -> %p\n", in_pszFileName, (void *)out_fileDesc.hFile);
+    else if (eResult != AK_FileNotFound)
+        TIGER_IO_TRACE(TigerIoTraceLevel_Errors, "Open('" TIGER_IO_OSCHAR_FMT "') failed: %d\n", in_pszFileName, eResult);
+    return eResult;
+}
+
+AKRESULT TigerPackageIo::OpenLooseFile(const AkOSChar *in_pszFileName, AkOpenMode in_eOpenMode, AkFileSystemFlags *in_pFlags, AkFileDesc &out_fileDesc)
+{
+    if (m_pWriteBehind && m_pWriteBehind->IsInitialized() && (in_eOpenMode == AK_OpenModeWrite || in_eOpenMode == AK_OpenModeWriteOvrwr))
+        return m_pWriteBehind->Open(in_pszFileName, in_eOpenMode, out_fileDesc);
+
+#if defined(AK_WIN)
     // Open the file without FILE_FLAG_OVERLAPPED and FILE_FLAG_NO_BUFFERING flags.
     AKRESULT eResult = CAkFileHelpers::OpenFile(
         in_pszFileName,
@@ -59,11 +142,81 @@ AKRESULT TigerPackageIo::Open(
         Temp.LowPart = ::GetFileSize(out_fileDesc.hFile, (LPDWORD)&Temp.HighPart);
         out_fileDesc.iFileSize = Temp.QuadPart;
         out_fileDesc.uSector = 0;
-        out_fileDesc.deviceID = m_deviceID;
+        out_fileDesc.deviceID = m_pRouter->Route(in_pFlags);
         out_fileDesc.pCustomParam = NULL;
         out_fileDesc.uCustomParamSize = 0;
+        m_faults.OnOpen(out_fileDesc, in_pFlags);
     }
     return eResult;
+#else
+    int flags;
+    switch (in_eOpenMode)
+    {
+    case AK_OpenModeRead:
+        flags = O_RDONLY;
+        break;
+    case AK_OpenModeWrite:
+    case AK_OpenModeWriteOvrwr:
+        flags = O_WRONLY | O_CREAT | O_TRUNC;
+        break;
+    case AK_OpenModeReadWrite:
+        flags = O_RDWR | O_CREAT;
+        break;
+    default:
+        return AK_InvalidParameter;
+    }
+
+    bool bDirect = m_bDirectIO && in_eOpenMode == AK_OpenModeRead;
+    int fd = -1;
+#if defined(O_DIRECT)
+    if (bDirect)
+    {
+        fd = ::open(in_pszFileName, flags | O_CLOEXEC | O_DIRECT);
+        // Some file systems (e.g. tmpfs) don't support O_DIRECT, read through the page cache.
+        if (fd < 0 && errno == EINVAL)
+            bDirect = false;
+        else if (fd < 0)
+            return errno == ENOENT ? AK_FileNotFound : AK_Fail;
+    }
+#endif
+    if (fd < 0)
+        fd = ::open(in_pszFileName, flags | O_CLOEXEC, 0644);
+    if (fd < 0)
+        return errno == ENOENT ? AK_FileNotFound : AK_Fail;
+#if !defined(O_DIRECT) && defined(F_NOCACHE)
+    if (bDirect)
+        bDirect = ::fcntl(fd, F_NOCACHE, 1) == 0;
+#elif !defined(O_DIRECT)
+    bDirect = false;
+#endif
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0)
+    {
+        ::close(fd);
+        return AK_Fail;
+    }
+
+    if (bDirect)
+    {
+        std::lock_guard<std::mutex> lock(m_directFilesLock);
+        m_directFileAlignments[fd] = QueryDirectIOAlignment(fd);
+    }
+    else if (in_pFlags && in_pFlags->bIsAutomaticStream)
+    {
+        // Streams are consumed front to back, let the kernel read ahead aggressively.
+        ::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    }
+
+    out_fileDesc.iFileSize = st.st_size;
+    out_fileDesc.uSector = 0;
+    out_fileDesc.deviceID = m_pRouter->Route(in_pFlags);
+    out_fileDesc.hFile = FD_TO_FILE_HANDLE(fd);
+    out_fileDesc.pCustomParam = NULL;
+    out_fileDesc.uCustomParamSize = 0;
+    m_faults.OnOpen(out_fileDesc, in_pFlags);
+    return AK_Success;
+#endif
 }
 
 AKRESULT TigerPackageIo::Open(
@@ -74,23 +227,83 @@ AKRESULT TigerPackageIo::Open(
     AkFileDesc &out_fileDesc      ///< Returned file descriptor.
 )
 {
-    printf("Loading file ref=%08X from PM\n", in_fileID);
-    size_t size = ddumbe_get_wwise_file_size_by_id(in_fileID);
-    if (size == SIZE_MAX)
-        return AK_FileNotFound;
+    TigerIoTimer timer;
+    AKRESULT eResult = OpenPackageFile(in_fileID, in_pFlags, io_bSyncOpen, out_fileDesc);
+    if (eResult == AK_Success && !io_bSyncOpen)
+    {
+        // Only the lookup happened so far, the Stream Manager reopens the file later.
+        TIGER_IO_TRACE(TigerIoTraceLevel_Files, "Open(ref=%08X) deferred\n", in_fileID);
+        return eResult;
+    }
+    GetIoCounters(m_pRouter->Route(in_pFlags)).RecordOpen(eResult, timer.ElapsedUs());
 
-    std::vector<uint8_t> buffer(size);
-    if (ddumbe_read_wwise_file_by_id(in_fileID, buffer.data(), size) != AK_Success)
-        return AK_Fail;
+    if (eResult == AK_Success)
+        TIGER_IO_TRACE(TigerIoTraceLevel_Files, "Open(ref=%08X) -> %p\n", in_fileID, (void *)out_fileDesc.hFile);
+    else if (eResult != AK_FileNotFound)
+        TIGER_IO_TRACE(TigerIoTraceLevel_Errors, "Open(ref=%08X) failed: %d\n", in_fileID, eResult);
+    return eResult;
+}
+
+AKRESULT TigerPackageIo::OpenPackageFile(AkFileID in_fileID, AkFileSystemFlags *in_pFlags, bool &io_bSyncOpen, AkFileDesc &out_fileDesc)
+{
+    TigerPackageFile file = {};
+    file.fileID = in_fileID;
+    file.uBlockSize = 1;
+    if (in_pFlags && in_pFlags->bIsAutomaticStream)
+    {
+        // Streamed media is read window by window in Read, only keep its size around. This is
+        // cheap enough to always be done synchronously. When the file was prefetched into the
+        // cache (see PrefetchTigerFiles), it is read from there instead.
+        io_bSyncOpen = true;
+        if (!m_fileCache.TryAcquire(in_fileID, file.buffer))
+        {
+            size_t size = ddumbe_get_wwise_file_size_by_id(m_pFileSource, in_fileID);
+            if (size == SIZE_MAX)
+                return AK_FileNotFound;
+            file.buffer.size = size;
+
+            // Only whole transfers of the device fit in whole blocks.
+            AkUInt32 uBlockSize = ddumbe_get_wwise_file_block_size_by_id(m_pFileSource, in_fileID);
+            AkUInt32 uGranularity = m_pRouter->GetGranularity(m_pRouter->Route(in_pFlags));
+            if (uBlockSize > 1 && uGranularity % uBlockSize == 0)
+                file.uBlockSize = uBlockSize;
+        }
+    }
+    else if (!io_bSyncOpen)
+    {
+        // Reading the whole file from its package is too slow for the caller's thread (usually
+        // the bank manager's). Only check that the file exists, start fetching it in the
+        // background and let the Stream Manager reopen it synchronously from its I/O thread,
+        // by which time the cache will usually hold it. The cache keeps it for the reopen even
+        // when it doesn't fit in the budget.
+        size_t size = ddumbe_get_wwise_file_size_by_id(m_pFileSource, in_fileID);
+        if (size == SIZE_MAX)
+            return AK_FileNotFound;
+        m_fileCache.PrefetchReserved(in_fileID);
 
-    auto fileId = this->m_nextPackageFileID++;
-    this->m_packageFiles[fileId] = buffer;
-    out_fileDesc.iFileSize = size;
+        out_fileDesc.iFileSize = size;
+        out_fileDesc.uSector = 0;
+        out_fileDesc.deviceID = m_pRouter->Route(in_pFlags);
+        out_fileDesc.pCustomParam = NULL;
+        out_fileDesc.uCustomParamSize = 0;
+        return AK_Success;
+    }
+    else
+    {
+        // The buffer is borrowed from the cache as-is, no copy is made until Read.
+        AKRESULT eResult = m_fileCache.Acquire(in_fileID, file.buffer);
+        if (eResult != AK_Success)
+            return eResult;
+    }
+
+    AkUInt64 uHandle = m_packageFiles.Insert(file);
+    out_fileDesc.iFileSize = file.buffer.size;
     out_fileDesc.uSector = 0;
-    out_fileDesc.deviceID = m_deviceID;
-    out_fileDesc.hFile = (AkFileHandle)(fileId | FILE_HANDLE_PACKAGE_BIT);
+    out_fileDesc.deviceID = m_pRouter->Route(in_pFlags);
+    out_fileDesc.hFile = (AkFileHandle)(uHandle | FILE_HANDLE_PACKAGE_BIT);
     out_fileDesc.pCustomParam = NULL;
     out_fileDesc.uCustomParamSize = 0;
+    m_faults.OnOpen(out_fileDesc, in_pFlags);
 
     return AK_Success;
 }
@@ -102,24 +315,63 @@ AKRESULT TigerPackageIo::Read(
     AkIOTransferInfo &io_transferInfo    ///< Synchronous data transfer info.
 )
 {
-    auto uFile = uint64_t(in_fileDesc.hFile);
-    if (uFile & FILE_HANDLE_PACKAGE_BIT)
+    TigerIoTimer timer;
+    // Injected faults count as time spent in the device, deadline misses included.
+    AKRESULT eResult = m_faults.BeforeTransfer(in_fileDesc, io_transferInfo.uRequestedSize);
+    if (eResult == AK_Success)
     {
-        auto fileId = uFile & ~FILE_HANDLE_PACKAGE_BIT;
-        // printf("Read(packageFileId=%d, heuristics=%d, buffer=%p, filePos=0x%x, size=0x%x)\n", fileId, in_heuristics, out_pBuffer, io_transferInfo.uFilePosition, io_transferInfo.uRequestedSize);
-        auto it = this->m_packageFiles.find(fileId);
-        if (it == this->m_packageFiles.end())
-            return AK_Fail;
+        auto uFile = uint64_t(in_fileDesc.hFile);
+        if (uFile & FILE_HANDLE_PACKAGE_BIT)
+            eResult = ReadPackageFile(uFile & ~FILE_HANDLE_PACKAGE_BIT, out_pBuffer, io_transferInfo);
+        else
+            eResult = ReadLooseFile(in_fileDesc, in_heuristics, out_pBuffer, io_transferInfo);
+    }
+    AkUInt64 uLatencyUs = timer.ElapsedUs();
+    TigerIoCounters &counters = GetIoCounters(in_fileDesc.deviceID);
+    counters.RecordRead(eResult, io_transferInfo.uRequestedSize, uLatencyUs);
 
-        auto &buffer = it->second;
-        if (io_transferInfo.uFilePosition + io_transferInfo.uRequestedSize > buffer.size())
-            return AK_Fail;
+    // fDeadline is how long the stream can wait for this transfer before it starves. When the
+    // transfer was queued first (TigerPackageIoDeferred), the time spent queued is already deducted.
+    counters.RecordDeadline(uLatencyUs, in_heuristics.fDeadline);
 
-        memcpy(out_pBuffer, buffer.data() + io_transferInfo.uFilePosition, io_transferInfo.uRequestedSize);
-        return AK_Success;
+    if (eResult == AK_Success)
+        TIGER_IO_TRACE(TigerIoTraceLevel_All, "Read(%p, filePos=0x%llx, size=0x%x, deadline=%.1fms)\n", (void *)in_fileDesc.hFile, (unsigned long long)io_transferInfo.uFilePosition, io_transferInfo.uRequestedSize, in_heuristics.fDeadline);
+    else
+        TIGER_IO_TRACE(TigerIoTraceLevel_Errors, "Read(%p, filePos=0x%llx, size=0x%x) failed: %d\n", (void *)in_fileDesc.hFile, (unsigned long long)io_transferInfo.uFilePosition, io_transferInfo.uRequestedSize, eResult);
+    return eResult;
+}
+
+AKRESULT TigerPackageIo::ReadPackageFile(AkUInt64 in_uPackageFileHandle, void *out_pBuffer, AkIOTransferInfo &io_transferInfo)
+{
+    TigerPackageFile file;
+    if (!m_packageFiles.Get(in_uPackageFileHandle, file))
+    {
+        TIGER_IO_TRACE(TigerIoTraceLevel_Errors, "Read of stale package file handle 0x%llx\n", (unsigned long long)in_uPackageFileHandle);
+        return AK_Fail;
+    }
+    m_readRecorder.Record(file.fileID, io_transferInfo.uFilePosition, io_transferInfo.uRequestedSize);
+
+    auto &buffer = file.buffer;
+    if (!buffer.data)
+    {
+        // Requests are rounded up to whole blocks (see GetBlockSize), so the last one of a file
+        // usually extends past its end.
+        if (io_transferInfo.uFilePosition > buffer.size)
+            return AK_Fail;
+        size_t uSize = AkMin((size_t)io_transferInfo.uRequestedSize, (size_t)(buffer.size - io_transferInfo.uFilePosition));
+        return ddumbe_read_wwise_file_range_by_id(m_pFileSource, file.fileID, io_transferInfo.uFilePosition, out_pBuffer, uSize);
     }
 
-    printf("Read(fileDesc=%d, heuristics=%d, buffer=%p, filePos=0x%x, size=0x%x)\n", in_fileDesc.hFile, in_heuristics, out_pBuffer, io_transferInfo.uFilePosition, io_transferInfo.uRequestedSize);
+    if (io_transferInfo.uFilePosition + io_transferInfo.uRequestedSize > buffer.size)
+        return AK_Fail;
+
+    memcpy(out_pBuffer, buffer.data + io_transferInfo.uFilePosition, io_transferInfo.uRequestedSize);
+    return AK_Success;
+}
+
+AKRESULT TigerPackageIo::ReadLooseFile(AkFileDesc &in_fileDesc, const AkIoHeuristics &in_heuristics, void *out_pBuffer, AkIOTransferInfo &io_transferInfo)
+{
+#if defined(AK_WIN)
     AKASSERT(out_pBuffer &&
              in_fileDesc.hFile != INVALID_HANDLE_VALUE);
 
@@ -141,6 +393,40 @@ AKRESULT TigerPackageIo::Read(
         return AK_Success;
     }
     return AK_Fail;
+#else
+    AKASSERT(out_pBuffer);
+    int fd = FILE_HANDLE_TO_FD(in_fileDesc.hFile);
+    off_t offset = (off_t)io_transferInfo.uFilePosition;
+    if (offset > in_fileDesc.iFileSize)
+        return AK_Fail;
+
+    // Requests are rounded up to the block size, the last one of a file may extend past its end.
+    size_t uSize = AkMin((size_t)io_transferInfo.uRequestedSize, (size_t)(in_fileDesc.iFileSize - offset));
+
+    AkUInt32 uAlign = GetDirectIOAlignment(in_fileDesc);
+    if (!uAlign)
+    {
+        if (in_heuristics.fDeadline < WILLNEED_DEADLINE_MS)
+            ::posix_fadvise(fd, offset + io_transferInfo.uRequestedSize, io_transferInfo.uRequestedSize, POSIX_FADV_WILLNEED);
+        return PreadAtLeast(fd, (uint8_t *)out_pBuffer, uSize, uSize, offset);
+    }
+
+    // Direct transfers must start, end and land on aligned boundaries. Reads past the end of the
+    // file are fine, they come back short.
+    off_t start = offset / uAlign * uAlign;
+    size_t uSpan = (offset + uSize + uAlign - 1) / uAlign * uAlign - start;
+    if (IsReadAligned(in_fileDesc, out_pBuffer, offset, io_transferInfo.uRequestedSize))
+        return PreadAtLeast(fd, (uint8_t *)out_pBuffer, uSpan, uSize, offset);
+
+    void *pBounce;
+    if (::posix_memalign(&pBounce, uAlign, uSpan) != 0)
+        return AK_InsufficientMemory;
+    AKRESULT eResult = PreadAtLeast(fd, (uint8_t *)pBounce, uSpan, offset + uSize - start, start);
+    if (eResult == AK_Success)
+        memcpy(out_pBuffer, (uint8_t *)pBounce + (offset - start), uSize);
+    ::free(pBounce);
+    return eResult;
+#endif
 }
 
 AKRESULT TigerPackageIo::Write(
@@ -150,6 +436,7 @@ AKRESULT TigerPackageIo::Write(
     AkIOTransferInfo &io_transferInfo    ///< Synchronous data transfer info.
 )
 {
+#if defined(AK_WIN)
     AKASSERT(in_pData &&
              in_fileDesc.hFile != INVALID_HANDLE_VALUE);
 
@@ -171,30 +458,115 @@ AKRESULT TigerPackageIo::Write(
         return AK_Success;
     }
     return AK_Fail;
+#else
+    AKASSERT(in_pData);
+    int fd = FILE_HANDLE_TO_FD(in_fileDesc.hFile);
+    off_t offset = (off_t)io_transferInfo.uFilePosition;
+
+    const uint8_t *pSrc = (const uint8_t *)in_pData;
+    size_t uRemaining = io_transferInfo.uRequestedSize;
+    while (uRemaining > 0)
+    {
+        ssize_t uWritten = ::pwrite(fd, pSrc, uRemaining, offset);
+        if (uWritten < 0 && errno == EINTR)
+            continue;
+        if (uWritten <= 0)
+            return AK_Fail;
+
+        pSrc += uWritten;
+        offset += uWritten;
+        uRemaining -= uWritten;
+    }
+    return AK_Success;
+#endif
 }
 
 AKRESULT TigerPackageIo::Close(
     AkFileDesc &in_fileDesc ///< File descriptor.
 )
 {
+    GetIoCounters(in_fileDesc.deviceID).RecordClose();
+    TIGER_IO_TRACE(TigerIoTraceLevel_Files, "Close(%p)\n", (void *)in_fileDesc.hFile);
+    m_faults.OnClose(in_fileDesc);
+
     auto uFile = uint64_t(in_fileDesc.hFile);
     if (uFile & FILE_HANDLE_PACKAGE_BIT)
     {
-        auto fileId = uFile & ~FILE_HANDLE_PACKAGE_BIT;
-        printf("Close(packageFileId=%d)\n", fileId);
-        this->m_packageFiles.erase(fileId);
+        TigerPackageFile file;
+        if (!m_packageFiles.Remove(uFile & ~FILE_HANDLE_PACKAGE_BIT, file))
+        {
+            TIGER_IO_TRACE(TigerIoTraceLevel_Errors, "Close of stale package file handle %p\n", (void *)in_fileDesc.hFile);
+            return AK_Fail;
+        }
+
+        if (file.buffer.data)
+            m_fileCache.Release(file.fileID);
         return AK_Success;
     }
 
-    printf("Close(fileDesc=%d)\n", in_fileDesc.hFile);
+#if defined(AK_WIN)
     AKASSERT(in_fileDesc.hFile != INVALID_HANDLE_VALUE);
     return CAkFileHelpers::CloseFile(in_fileDesc.hFile);
+#else
+    int fd = FILE_HANDLE_TO_FD(in_fileDesc.hFile);
+    if (m_bDirectIO)
+    {
+        std::lock_guard<std::mutex> lock(m_directFilesLock);
+        m_directFileAlignments.erase(fd);
+    }
+    return ::close(fd) == 0 ? AK_Success : AK_Fail;
+#endif
 }
 
+AkUInt32 TigerPackageIo::GetDirectIOAlignment(const AkFileDesc &in_fileDesc)
+{
+#if defined(AK_WIN)
+    return 0;
+#else
+    if (!m_bDirectIO || IsPackageFile(in_fileDesc))
+        return 0;
+
+    std::lock_guard<std::mutex> lock(m_directFilesLock);
+    auto it = m_directFileAlignments.find(FILE_HANDLE_TO_FD(in_fileDesc.hFile));
+    return it != m_directFileAlignments.end() ? it->second : 0;
+#endif
+}
+
+bool TigerPackageIo::IsReadAligned(const AkFileDesc &in_fileDesc, const void *in_pBuffer, AkUInt64 in_uPosition, AkUInt32 in_uSize)
+{
+    AkUInt32 uAlign = GetDirectIOAlignment(in_fileDesc);
+    return !uAlign || (in_uPosition % uAlign == 0 && in_uSize % uAlign == 0 && (uintptr_t)in_pBuffer % uAlign == 0);
+}
+
+bool TigerPackageIo::IsPackageFile(const AkFileDesc &in_fileDesc)
+{
+    return uint64_t(in_fileDesc.hFile) & FILE_HANDLE_PACKAGE_BIT;
+}
+
+#if !defined(AK_WIN)
+int TigerPackageIo::GetLooseFileDescriptor(const AkFileDesc &in_fileDesc)
+{
+    return FILE_HANDLE_TO_FD(in_fileDesc.hFile);
+}
+#endif
+
 AkUInt32 TigerPackageIo::GetBlockSize(
     AkFileDesc &in_fileDesc ///< File descriptor.
 )
 {
+    auto uFile = uint64_t(in_fileDesc.hFile);
+    if (!(uFile & FILE_HANDLE_PACKAGE_BIT))
+    {
+        AkUInt32 uAlign = GetDirectIOAlignment(in_fileDesc);
+        return uAlign ? uAlign : 1;
+    }
+
+    // Streamed package files are decompressed block by block, have the Stream Manager request
+    // them in whole blocks when their blocks line up with its transfers (see OpenPackageFile).
+    // Files held by the cache are plain memory and can be read at any position.
+    TigerPackageFile file;
+    if (m_packageFiles.Get(uFile & ~FILE_HANDLE_PACKAGE_BIT, file) && !file.buffer.data)
+        return file.uBlockSize;
     return 1;
 }
 
@@ -205,8 +577,9 @@ void TigerPackageIo::GetDeviceDesc(
     static const AkOSChar szDeviceName[] = AKTEXT("TigerPackageIo");
 
     out_deviceDesc.bCanRead = true;
-    out_deviceDesc.bCanWrite = false;
-    out_deviceDesc.deviceID = m_deviceID;
+    // Loose files opened for writing are written here when there is no write-behind device.
+    out_deviceDesc.bCanWrite = true;
+    out_deviceDesc.deviceID = m_devices.GetDefaultDevice();
     out_deviceDesc.uStringSize = AKPLATFORM::OsStrLen(szDeviceName);
     AKPLATFORM::SafeStrCpy(out_deviceDesc.szDeviceName, szDeviceName, AK_MONITOR_DEVICENAME_MAXLENGTH);
 }
@@ -1,17 +1,35 @@
 #pragma once
 
+#include <mutex>
 #include <unordered_map>
 #include <vector>
 #include <AK/SoundEngine/Common/AkSoundEngine.h>
 #include <AK/SoundEngine/Common/AkStreamMgrModule.h>
+#include "tiger_device_router.h"
+#include "tiger_fault_injector.h"
+#include "tiger_file_cache.h"
+#include "tiger_io_stats.h"
+#include "tiger_package_file_table.h"
+#include "tiger_read_recorder.h"
+#include "tiger_write_behind.h"
+
+#define TIGER_FILE_CACHE_DEFAULT_BUDGET (128 * 1024 * 1024)
+
+// Alignment of direct (unbuffered) loose-file transfers, when the file system doesn't report its
+// own through statx.
+#define TIGER_DIRECT_IO_DEFAULT_ALIGNMENT 4096
 
 class TigerPackageIo : public AK::StreamMgr::IAkFileLocationResolver, public AK::StreamMgr::IAkIOHookBlocking
 {
 public:
-    TigerPackageIo() : m_deviceID(AK_INVALID_DEVICE_ID) {}
+    TigerPackageIo() : m_pRouter(&m_devices), m_pFileSource(NULL), m_fileCache(TIGER_FILE_CACHE_DEFAULT_BUDGET), m_pWriteBehind(NULL), m_bDirectIO(false) {}
 
     AKRESULT Init(const AkDeviceSettings &settings);
 
+    // Gives in_eClass a device of its own, see TigerDeviceRouter. Must be called after Init,
+    // before any file is opened.
+    AKRESULT AddDevice(TigerDeviceClass in_eClass, const AkDeviceSettings &settings);
+
     void Term();
 
     // Returns a file descriptor for a given file name (string).
@@ -60,8 +78,80 @@ public:
 
     virtual AkUInt32 GetDeviceData();
 
+    TigerFileCache &GetFileCache() { return m_fileCache; }
+
+    // Counters of the device in_deviceID, see TigerDeviceRouter::ClassOf.
+    TigerIoCounters &GetIoCounters(AkDeviceID in_deviceID) { return m_ioCounters[m_pRouter->ClassOf(in_deviceID)]; }
+
+    // Faults injected into every transfer of this hook, see TigerFaultInjector.
+    TigerFaultInjector &GetFaultInjector() { return m_faults; }
+    TigerReadRecorder &GetReadRecorder() { return m_readRecorder; }
+
+    // Counters of the device serving in_eClass: a class without a device of its own reports the
+    // default device's, which it shares.
+    void GetIoStats(TigerDeviceClass in_eClass, TigerIoDeviceStats &out_stats);
+    void ResetIoStats();
+
+    // Router of the devices files are opened on, this hook's own by default. A hook that delegates
+    // to this one (TigerPackageIoDeferred) shares its router, so routing and per-device counters
+    // follow its devices. Must be set before Init.
+    void SetRouter(const TigerDeviceRouter *in_pRouter) { m_pRouter = in_pRouter; }
+
+    // When set, loose files opened for reading bypass the page cache (O_DIRECT, or F_NOCACHE on
+    // Apple platforms), and GetBlockSize reports the alignment the file system requires for them.
+    // Misaligned transfers (e.g. into user buffers of standard streams) go through an aligned
+    // bounce buffer. POSIX only, must be set before Init.
+    void SetDirectIO(bool in_bDirectIO) { m_bDirectIO = in_bDirectIO; }
+
+    // Opaque handle to the Rust file provider serving the package files of this hook, handed back
+    // to the ddumbe_* callbacks. NULL (the default) selects the process-wide provider. Must be
+    // set before Init.
+    void SetFileSource(const void *in_pFileSource)
+    {
+        m_pFileSource = in_pFileSource;
+        m_fileCache.SetFileSource(in_pFileSource);
+    }
+
+    // When set, loose files opened for writing only (output and profiler captures) are opened on
+    // this device instead, so their writes don't block the I/O thread. Must be set before any
+    // file is opened.
+    void SetWriteBehind(TigerWriteBehindIo *in_pWriteBehind) { m_pWriteBehind = in_pWriteBehind; }
+
+    // Whether a read of in_uSize bytes at in_uPosition of in_fileDesc into in_pBuffer can be
+    // issued to the file as-is: always true for buffered files, only if everything is aligned for
+    // direct ones.
+    bool IsReadAligned(const AkFileDesc &in_fileDesc, const void *in_pBuffer, AkUInt64 in_uPosition, AkUInt32 in_uSize);
+
+    // Whether in_fileDesc was opened through Open(AkFileID), as opposed to a loose file.
+    static bool IsPackageFile(const AkFileDesc &in_fileDesc);
+#if !defined(AK_WIN)
+    static int GetLooseFileDescriptor(const AkFileDesc &in_fileDesc);
+#endif
+
 private:
-    AkDeviceID m_deviceID;
-    std::unordered_map<uint64_t, std::vector<uint8_t>> m_packageFiles;
-    uint64_t m_nextPackageFileID;
+    AKRESULT OpenLooseFile(const AkOSChar *in_pszFileName, AkOpenMode in_eOpenMode, AkFileSystemFlags *in_pFlags, AkFileDesc &out_fileDesc);
+    AKRESULT OpenPackageFile(AkFileID in_fileID, AkFileSystemFlags *in_pFlags, bool &io_bSyncOpen, AkFileDesc &out_fileDesc);
+    AKRESULT ReadLooseFile(AkFileDesc &in_fileDesc, const AkIoHeuristics &in_heuristics, void *out_pBuffer, AkIOTransferInfo &io_transferInfo);
+    AKRESULT ReadPackageFile(AkUInt64 in_uPackageFileHandle, void *out_pBuffer, AkIOTransferInfo &io_transferInfo);
+
+    // Alignment required by a loose file opened for direct I/O, 0 if it is buffered.
+    AkUInt32 GetDirectIOAlignment(const AkFileDesc &in_fileDesc);
+
+    TigerDeviceRouter m_devices;
+    const TigerDeviceRouter *m_pRouter;
+    // Open package files. Several I/O threads open, read and close them concurrently when this
+    // hook backs TigerPackageIoDeferred.
+    TigerPackageFileTable m_packageFiles;
+    const void *m_pFileSource;
+    TigerFileCache m_fileCache;
+    // One per device class, only the classes with a device of their own are counted in.
+    TigerIoCounters m_ioCounters[TigerDeviceClass_Count];
+    TigerFaultInjector m_faults;
+    TigerReadRecorder m_readRecorder;
+    TigerWriteBehindIo *m_pWriteBehind;
+
+    bool m_bDirectIO;
+    // Loose files opened for direct I/O -> their alignment.
+    std::mutex m_directFilesLock;
+    std::unordered_map<int, AkUInt32> m_directFileAlignments;
 };
\ No newline at end of file
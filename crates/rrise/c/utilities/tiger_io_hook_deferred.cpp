@@ -0,0 +1,288 @@
+#include <algorithm>
+#include "tiger_io_hook_deferred.h"
+
+// Bound of the deadlines transfers are ordered by, in milliseconds (about 11 days).
+#define TIGER_MAX_DEADLINE_MS 1e9f
+
+AKRESULT TigerPackageIoDeferred::Init(const AkDeviceSettings &in_deviceSettings, AkUInt32 in_uNumWorkers, AkUInt32 in_uUringQueueDepth)
+{
+    if (in_deviceSettings.uSchedulerTypeFlags != AK_SCHEDULER_DEFERRED_LINED_UP)
+    {
+        AKASSERT(!"TigerPackageIoDeferred I/O hook only works with AK_SCHEDULER_DEFERRED_LINED_UP devices");
+        return AK_Fail;
+    }
+
+    if (in_uNumWorkers == 0)
+        return AK_InvalidParameter;
+
+    // If the Stream Manager's File Location Resolver was not set yet, set this object as the
+    // File Location Resolver (this I/O hook is also able to resolve file location).
+    if (!AK::StreamMgr::GetFileLocationResolver())
+        AK::StreamMgr::SetFileLocationResolver(this);
+
+    // Create a device in the Stream Manager, specifying this as the hook.
+    if (m_devices.Init(in_deviceSettings, this) != AK_Success)
+        return AK_Fail;
+
+    m_bStopWorkers = false;
+    for (AkUInt32 i = 0; i < in_uNumWorkers; i++)
+        m_workers.emplace_back(&TigerPackageIoDeferred::WorkerMain, this);
+
+#if !defined(AK_WIN)
+    if (in_uUringQueueDepth > 0 && m_uring.Init(in_uUringQueueDepth, &TigerPackageIoDeferred::OnUringReadComplete))
+    {
+        m_uringReads.resize(in_uUringQueueDepth);
+        for (auto &read : m_uringReads)
+            m_freeUringReads.push_back(&read);
+        TIGER_IO_TRACE(TigerIoTraceLevel_Files, "TigerPackageIoDeferred: io_uring enabled (depth=%u, sqpoll=%d)\n", in_uUringQueueDepth, m_uring.UsesKernelSubmissionThread());
+    }
+    else if (in_uUringQueueDepth > 0)
+        TIGER_IO_TRACE(TigerIoTraceLevel_Errors, "TigerPackageIoDeferred: io_uring unavailable, loose files are read by the workers\n");
+#endif
+
+    return AK_Success;
+}
+
+AKRESULT TigerPackageIoDeferred::AddDevice(TigerDeviceClass in_eClass, const AkDeviceSettings &in_deviceSettings)
+{
+    if (in_deviceSettings.uSchedulerTypeFlags != AK_SCHEDULER_DEFERRED_LINED_UP)
+        return AK_InvalidParameter;
+
+    return m_devices.AddDevice(in_eClass, in_deviceSettings, this);
+}
+
+void TigerPackageIoDeferred::Term()
+{
+    if (AK::StreamMgr::GetFileLocationResolver() == this)
+        AK::StreamMgr::SetFileLocationResolver(NULL);
+
+    // Destroying the devices flushes all pending transfers, so workers are only stopped afterwards.
+    m_devices.Term();
+
+    {
+        std::lock_guard<std::mutex> lock(m_queueLock);
+        m_bStopWorkers = true;
+    }
+    m_queueSignal.notify_all();
+    for (auto &worker : m_workers)
+        worker.join();
+    m_workers.clear();
+
+    m_uring.Term();
+    m_uringReads.clear();
+    m_freeUringReads.clear();
+
+    m_files.GetFileCache().Clear();
+}
+
+AKRESULT TigerPackageIoDeferred::Open(
+    const AkOSChar *in_pszFileName, ///< File name.
+    AkOpenMode in_eOpenMode,        ///< Open mode.
+    AkFileSystemFlags *in_pFlags,   ///< Special flags. Can pass NULL.
+    bool &io_bSyncOpen,             ///< If true, the file must be opened synchronously. Otherwise it is left at the File Location Resolver's discretion. Return false if Open needs to be deferred.
+    AkFileDesc &out_fileDesc        ///< Returned file descriptor.
+)
+{
+    AKRESULT eResult = m_files.Open(in_pszFileName, in_eOpenMode, in_pFlags, io_bSyncOpen, out_fileDesc);
+    // m_files has no device of its own: files it didn't hand over to another device (the
+    // write-behind one) come back without one.
+    if (eResult == AK_Success && out_fileDesc.deviceID == AK_INVALID_DEVICE_ID)
+        out_fileDesc.deviceID = m_devices.Route(in_pFlags);
+    return eResult;
+}
+
+AKRESULT TigerPackageIoDeferred::Open(
+    AkFileID in_fileID,           ///< File ID.
+    AkOpenMode in_eOpenMode,      ///< Open mode.
+    AkFileSystemFlags *in_pFlags, ///< Special flags. Can pass NULL.
+    bool &io_bSyncOpen,           ///< If true, the file must be opened synchronously. Otherwise it is left at the File Location Resolver's discretion. Return false if Open needs to be deferred.
+    AkFileDesc &out_fileDesc      ///< Returned file descriptor.
+)
+{
+    AKRESULT eResult = m_files.Open(in_fileID, in_eOpenMode, in_pFlags, io_bSyncOpen, out_fileDesc);
+    if (eResult == AK_Success)
+        out_fileDesc.deviceID = m_devices.Route(in_pFlags);
+    return eResult;
+}
+
+AKRESULT TigerPackageIoDeferred::Read(
+    AkFileDesc &in_fileDesc,               ///< File descriptor.
+    const AkIoHeuristics &in_heuristics,   ///< Heuristics for this data transfer.
+    AkAsyncIOTransferInfo &io_transferInfo ///< Asynchronous data transfer info.
+)
+{
+    // Misaligned reads of direct files need a bounce buffer, leave them to TigerPackageIo. So are
+    // reads while faults are injected, which only TigerPackageIo::Read does.
+    if (!m_uring.IsActive() || TigerPackageIo::IsPackageFile(in_fileDesc) || m_files.GetFaultInjector().IsActive() ||
+        !m_files.IsReadAligned(in_fileDesc, io_transferInfo.pBuffer, io_transferInfo.uFilePosition, io_transferInfo.uRequestedSize) ||
+        !SubmitUringRead(in_fileDesc, in_heuristics, io_transferInfo))
+        Enqueue(in_fileDesc, in_heuristics, io_transferInfo, false);
+    return AK_Success;
+}
+
+AKRESULT TigerPackageIoDeferred::Write(
+    AkFileDesc &in_fileDesc,               ///< File descriptor.
+    const AkIoHeuristics &in_heuristics,   ///< Heuristics for this data transfer.
+    AkAsyncIOTransferInfo &io_transferInfo ///< Platform-specific asynchronous IO operation info.
+)
+{
+    Enqueue(in_fileDesc, in_heuristics, io_transferInfo, true);
+    return AK_Success;
+}
+
+void TigerPackageIoDeferred::Enqueue(AkFileDesc &in_fileDesc, const AkIoHeuristics &in_heuristics, AkAsyncIOTransferInfo &io_transferInfo, bool in_bWrite)
+{
+    // Idle streams come with huge, even infinite, deadlines: clamp them (NaN included) before the
+    // conversion, which is undefined out of range. Nothing is held back that long anyway.
+    float fDeadlineMs = in_heuristics.fDeadline;
+    if (!(fDeadlineMs < TIGER_MAX_DEADLINE_MS))
+        fDeadlineMs = TIGER_MAX_DEADLINE_MS;
+    else if (fDeadlineMs < -TIGER_MAX_DEADLINE_MS)
+        fDeadlineMs = -TIGER_MAX_DEADLINE_MS;
+    auto deadline = std::chrono::steady_clock::now() +
+                    std::chrono::microseconds((AkInt64)(fDeadlineMs * 1000.f));
+    {
+        std::lock_guard<std::mutex> lock(m_queueLock);
+        m_pendingTransfers.push_back({in_fileDesc, in_heuristics, &io_transferInfo, deadline, m_uNextSequence++, in_bWrite, false});
+        std::push_heap(m_pendingTransfers.begin(), m_pendingTransfers.end(), TransferServedAfter());
+    }
+    m_queueSignal.notify_one();
+}
+
+bool TigerPackageIoDeferred::SubmitUringRead(AkFileDesc &in_fileDesc, const AkIoHeuristics &in_heuristics, AkAsyncIOTransferInfo &io_transferInfo)
+{
+#if defined(AK_WIN)
+    return false;
+#else
+    UringRead *pRead;
+    {
+        std::lock_guard<std::mutex> lock(m_uringReadsLock);
+        if (m_freeUringReads.empty())
+            return false;
+        pRead = m_freeUringReads.back();
+        m_freeUringReads.pop_back();
+    }
+
+    pRead->pOwner = this;
+    pRead->deviceID = in_fileDesc.deviceID;
+    pRead->pTransferInfo = &io_transferInfo;
+    pRead->fDeadline = in_heuristics.fDeadline;
+    // The last request of a file may extend past its end, it then comes back short.
+    pRead->uExpectedSize = io_transferInfo.uFilePosition < (AkUInt64)in_fileDesc.iFileSize
+                               ? AkMin((AkUInt64)io_transferInfo.uRequestedSize, in_fileDesc.iFileSize - io_transferInfo.uFilePosition)
+                               : 0;
+    pRead->timer = TigerIoTimer();
+    if (m_uring.SubmitRead(TigerPackageIo::GetLooseFileDescriptor(in_fileDesc), io_transferInfo.pBuffer, io_transferInfo.uRequestedSize, io_transferInfo.uFilePosition, pRead))
+        return true;
+
+    std::lock_guard<std::mutex> lock(m_uringReadsLock);
+    m_freeUringReads.push_back(pRead);
+    return false;
+#endif
+}
+
+void TigerPackageIoDeferred::OnUringReadComplete(void *in_pCookie, int64_t in_iResult)
+{
+    UringRead *pRead = (UringRead *)in_pCookie;
+    TigerPackageIoDeferred *pThis = pRead->pOwner;
+    AkAsyncIOTransferInfo &info = *pRead->pTransferInfo;
+
+    AKRESULT eResult = in_iResult >= 0 && (AkUInt64)in_iResult >= pRead->uExpectedSize ? AK_Success : AK_Fail;
+    AkUInt64 uLatencyUs = pRead->timer.ElapsedUs();
+    TigerIoCounters &counters = pThis->m_files.GetIoCounters(pRead->deviceID);
+    counters.RecordRead(eResult, info.uRequestedSize, uLatencyUs);
+    counters.RecordDeadline(uLatencyUs, pRead->fDeadline);
+    if (eResult != AK_Success)
+        TIGER_IO_TRACE(TigerIoTraceLevel_Errors, "io_uring Read(filePos=0x%llx, size=0x%x) failed: %lld\n", (unsigned long long)info.uFilePosition, info.uRequestedSize, (long long)in_iResult);
+
+    {
+        std::lock_guard<std::mutex> lock(pThis->m_uringReadsLock);
+        pThis->m_freeUringReads.push_back(pRead);
+    }
+    info.pCallback(&info, eResult);
+}
+
+void TigerPackageIoDeferred::Cancel(
+    AkFileDesc &in_fileDesc,                ///< File descriptor.
+    AkAsyncIOTransferInfo &io_transferInfo, ///< Transfer info to cancel.
+    bool &io_bCancelAllTransfersForThisFile ///< Flag indicating whether all transfers should be cancelled for this file (see notes in function description).
+)
+{
+    // Transfers that a worker already picked up run to completion. The ones still queued are
+    // flagged, and the worker that dequeues them reports AK_Cancelled without touching the file.
+    std::lock_guard<std::mutex> lock(m_queueLock);
+    for (auto &transfer : m_pendingTransfers)
+    {
+        if (io_bCancelAllTransfersForThisFile ? transfer.fileDesc.hFile == in_fileDesc.hFile
+                                              : transfer.pTransferInfo == &io_transferInfo)
+            transfer.bCancelled = true;
+    }
+}
+
+AKRESULT TigerPackageIoDeferred::Close(
+    AkFileDesc &in_fileDesc ///< File descriptor.
+)
+{
+    return m_files.Close(in_fileDesc);
+}
+
+AkUInt32 TigerPackageIoDeferred::GetBlockSize(
+    AkFileDesc &in_fileDesc ///< File descriptor.
+)
+{
+    return m_files.GetBlockSize(in_fileDesc);
+}
+
+void TigerPackageIoDeferred::GetDeviceDesc(
+    AkDeviceDesc &out_deviceDesc ///< Device description.
+)
+{
+    static const AkOSChar szDeviceName[] = AKTEXT("TigerPackageIoDeferred");
+
+    out_deviceDesc.bCanRead = true;
+    // Loose files opened for writing are written here when there is no write-behind device.
+    out_deviceDesc.bCanWrite = true;
+    out_deviceDesc.deviceID = m_devices.GetDefaultDevice();
+    out_deviceDesc.uStringSize = AKPLATFORM::OsStrLen(szDeviceName);
+    AKPLATFORM::SafeStrCpy(out_deviceDesc.szDeviceName, szDeviceName, AK_MONITOR_DEVICENAME_MAXLENGTH);
+}
+
+AkUInt32 TigerPackageIoDeferred::GetDeviceData()
+{
+    return (AkUInt32)m_workers.size();
+}
+
+void TigerPackageIoDeferred::WorkerMain()
+{
+    for (;;)
+    {
+        Transfer transfer;
+        {
+            std::unique_lock<std::mutex> lock(m_queueLock);
+            m_queueSignal.wait(lock, [this]
+                               { return m_bStopWorkers || !m_pendingTransfers.empty(); });
+            if (m_pendingTransfers.empty())
+                return;
+
+            std::pop_heap(m_pendingTransfers.begin(), m_pendingTransfers.end(), TransferServedAfter());
+            transfer = m_pendingTransfers.back();
+            m_pendingTransfers.pop_back();
+        }
+
+        // Hand the hook the time left until the deadline rather than the original budget, so
+        // that time spent queued counts towards deadline misses. It may already be negative.
+        auto remaining = transfer.deadline - std::chrono::steady_clock::now();
+        transfer.heuristics.fDeadline = std::chrono::duration_cast<std::chrono::microseconds>(remaining).count() / 1000.f;
+
+        AkAsyncIOTransferInfo &info = *transfer.pTransferInfo;
+        AKRESULT eResult;
+        if (transfer.bCancelled)
+            eResult = AK_Cancelled;
+        else if (transfer.bWrite)
+            eResult = m_files.Write(transfer.fileDesc, transfer.heuristics, info.pBuffer, info);
+        else
+            eResult = m_files.Read(transfer.fileDesc, transfer.heuristics, info.pBuffer, info);
+
+        info.pCallback(&info, eResult);
+    }
+}
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "tiger_io_hook.h"
+#include "tiger_io_uring.h"
+
+// Deferred variant of TigerPackageIo. Transfers are queued by the Stream Manager and completed
+// by a pool of worker threads, so several streams and bank loads can read and decompress package
+// data in parallel instead of stalling the Stream Manager's I/O thread one at a time.
+//
+// Pending transfers are served earliest deadline first (AkIoHeuristics::fDeadline, made absolute
+// when the transfer is queued), then highest priority first, then in submission order. A streamed
+// track that is about to underrun therefore overtakes a bank load queued before it.
+//
+// Reads of loose files can optionally be handed to the kernel through io_uring instead of a
+// worker (see TigerUring). When io_uring is unavailable or its queue is full, they go through
+// the worker pool like every other transfer.
+//
+// File resolution and the actual reads are delegated to a TigerPackageIo instance, which is never
+// registered as a device itself.
+class TigerPackageIoDeferred : public AK::StreamMgr::IAkFileLocationResolver, public AK::StreamMgr::IAkIOHookDeferred
+{
+public:
+    TigerPackageIoDeferred() : m_uNextSequence(0), m_bStopWorkers(false) { m_files.SetRouter(&m_devices); }
+
+    // in_uUringQueueDepth is the number of loose-file reads that may be in flight in io_uring,
+    // 0 disables it.
+    AKRESULT Init(const AkDeviceSettings &settings, AkUInt32 in_uNumWorkers, AkUInt32 in_uUringQueueDepth);
+
+    // Gives in_eClass a device of its own, see TigerDeviceRouter. Its transfers are still served
+    // by the shared workers, in deadline order with every other device's. Must be called after
+    // Init, before any file is opened.
+    AKRESULT AddDevice(TigerDeviceClass in_eClass, const AkDeviceSettings &settings);
+
+    void Term();
+
+    // Returns a file descriptor for a given file name (string).
+    virtual AKRESULT Open(
+        const AkOSChar *in_pszFileName, // File name.
+        AkOpenMode in_eOpenMode,        // Open mode.
+        AkFileSystemFlags *in_pFlags,   // Special flags. Can pass NULL.
+        bool &io_bSyncOpen,             // If true, the file must be opened synchronously. Otherwise it is left at the File Location Resolver's discretion. Return false if Open needs to be deferred.
+        AkFileDesc &out_fileDesc        // Returned file descriptor.
+    );
+
+    // Returns a file descriptor for a given file ID.
+    virtual AKRESULT Open(
+        AkFileID in_fileID,           // File ID.
+        AkOpenMode in_eOpenMode,      // Open mode.
+        AkFileSystemFlags *in_pFlags, // Special flags. Can pass NULL.
+        bool &io_bSyncOpen,           // If true, the file must be opened synchronously. Otherwise it is left at the File Location Resolver's discretion. Return false if Open needs to be deferred.
+        AkFileDesc &out_fileDesc      // Returned file descriptor.
+    );
+
+    virtual AKRESULT Read(
+        AkFileDesc &in_fileDesc,               ///< File descriptor.
+        const AkIoHeuristics &in_heuristics,   ///< Heuristics for this data transfer.
+        AkAsyncIOTransferInfo &io_transferInfo ///< Asynchronous data transfer info.
+    );
+
+    virtual AKRESULT Write(
+        AkFileDesc &in_fileDesc,               ///< File descriptor.
+        const AkIoHeuristics &in_heuristics,   ///< Heuristics for this data transfer.
+        AkAsyncIOTransferInfo &io_transferInfo ///< Platform-specific asynchronous IO operation info.
+    );
+
+    virtual void Cancel(
+        AkFileDesc &in_fileDesc,                    ///< File descriptor.
+        AkAsyncIOTransferInfo &io_transferInfo,     ///< Transfer info to cancel.
+        bool &io_bCancelAllTransfersForThisFile     ///< Flag indicating whether all transfers should be cancelled for this file (see notes in function description).
+    );
+
+    virtual AKRESULT Close(
+        AkFileDesc &in_fileDesc ///< File descriptor.
+    );
+
+    virtual AkUInt32 GetBlockSize(
+        AkFileDesc &in_fileDesc ///< File descriptor.
+    );
+
+    virtual void GetDeviceDesc(
+        AkDeviceDesc &out_deviceDesc ///< Device description.
+    );
+
+    virtual AkUInt32 GetDeviceData();
+
+    TigerFileCache &GetFileCache() { return m_files.GetFileCache(); }
+    TigerFaultInjector &GetFaultInjector() { return m_files.GetFaultInjector(); }
+    TigerReadRecorder &GetReadRecorder() { return m_files.GetReadRecorder(); }
+
+    // Transfers are counted by the underlying TigerPackageIo, under the devices of this hook.
+    void GetIoStats(TigerDeviceClass in_eClass, TigerIoDeviceStats &out_stats) { m_files.GetIoStats(in_eClass, out_stats); }
+    void ResetIoStats() { m_files.ResetIoStats(); }
+
+    bool IsUringActive() const { return m_uring.IsActive(); }
+
+    // See TigerPackageIo::SetDirectIO.
+    void SetDirectIO(bool in_bDirectIO) { m_files.SetDirectIO(in_bDirectIO); }
+
+    // See TigerPackageIo::SetFileSource.
+    void SetFileSource(const void *in_pFileSource) { m_files.SetFileSource(in_pFileSource); }
+
+    // See TigerPackageIo::SetWriteBehind.
+    void SetWriteBehind(TigerWriteBehindIo *in_pWriteBehind) { m_files.SetWriteBehind(in_pWriteBehind); }
+
+private:
+    struct Transfer
+    {
+        AkFileDesc fileDesc;
+        AkIoHeuristics heuristics;
+        AkAsyncIOTransferInfo *pTransferInfo;
+        std::chrono::steady_clock::time_point deadline;
+        AkUInt64 uSequence;
+        bool bWrite;
+        bool bCancelled;
+    };
+
+    // Heap ordering of m_pendingTransfers: true if `a` must be served after `b`.
+    struct TransferServedAfter
+    {
+        bool operator()(const Transfer &a, const Transfer &b) const
+        {
+            if (a.deadline != b.deadline)
+                return a.deadline > b.deadline;
+            if (a.heuristics.priority != b.heuristics.priority)
+                return a.heuristics.priority < b.heuristics.priority;
+            return a.uSequence > b.uSequence;
+        }
+    };
+
+    void Enqueue(AkFileDesc &in_fileDesc, const AkIoHeuristics &in_heuristics, AkAsyncIOTransferInfo &io_transferInfo, bool in_bWrite);
+
+    // A loose-file read in flight in m_uring.
+    struct UringRead
+    {
+        TigerPackageIoDeferred *pOwner;
+        AkDeviceID deviceID;
+        AkAsyncIOTransferInfo *pTransferInfo;
+        AkReal32 fDeadline;
+        AkUInt64 uExpectedSize;
+        TigerIoTimer timer;
+    };
+
+    bool SubmitUringRead(AkFileDesc &in_fileDesc, const AkIoHeuristics &in_heuristics, AkAsyncIOTransferInfo &io_transferInfo);
+    static void OnUringReadComplete(void *in_pCookie, int64_t in_iResult);
+
+    void WorkerMain();
+
+    TigerPackageIo m_files;
+    TigerDeviceRouter m_devices;
+
+    std::vector<std::thread> m_workers;
+    std::mutex m_queueLock;
+    std::condition_variable m_queueSignal;
+    std::vector<Transfer> m_pendingTransfers; // Binary heap, see TransferServedAfter.
+    AkUInt64 m_uNextSequence;
+    bool m_bStopWorkers;
+
+    TigerUring m_uring;
+    std::mutex m_uringReadsLock;
+    std::vector<UringRead> m_uringReads;
+    std::vector<UringRead *> m_freeUringReads;
+};
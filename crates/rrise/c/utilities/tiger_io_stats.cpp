@@ -0,0 +1,90 @@
+#include "tiger_io_stats.h"
+
+std::atomic<AkUInt32> g_tigerIoTraceLevel(TigerIoTraceLevel_Errors);
+
+void TigerIoCounters::RecordOpen(AKRESULT in_eResult, AkUInt64 in_uLatencyUs)
+{
+    m_uOpens.fetch_add(1, std::memory_order_relaxed);
+    if (in_eResult != AK_Success)
+        m_uOpenFailures.fetch_add(1, std::memory_order_relaxed);
+    m_openLatencyUs[LatencyBucket(in_uLatencyUs)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void TigerIoCounters::RecordRead(AKRESULT in_eResult, AkUInt64 in_uBytes, AkUInt64 in_uLatencyUs)
+{
+    m_uReads.fetch_add(1, std::memory_order_relaxed);
+    if (in_eResult == AK_Success)
+        m_uBytesRead.fetch_add(in_uBytes, std::memory_order_relaxed);
+    else
+        m_uReadFailures.fetch_add(1, std::memory_order_relaxed);
+    m_readLatencyUs[LatencyBucket(in_uLatencyUs)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void TigerIoCounters::RecordDeadline(AkUInt64 in_uLatencyUs, AkReal32 in_fDeadlineMs)
+{
+    AkReal32 fLatenessMs = in_uLatencyUs / 1000.f - in_fDeadlineMs;
+    // Clamped like the deadlines of TigerPackageIoDeferred, the conversion is undefined past it.
+    if (fLatenessMs > 1e9f)
+        fLatenessMs = 1e9f;
+    if (fLatenessMs > 0.f)
+        RecordDeadlineMiss((AkUInt64)(fLatenessMs * 1000.f));
+}
+
+void TigerIoCounters::RecordDeadlineMiss(AkUInt64 in_uLatenessUs)
+{
+    m_uDeadlineMisses.fetch_add(1, std::memory_order_relaxed);
+    AkUInt64 uMax = m_uMaxLatenessUs.load(std::memory_order_relaxed);
+    while (in_uLatenessUs > uMax && !m_uMaxLatenessUs.compare_exchange_weak(uMax, in_uLatenessUs, std::memory_order_relaxed))
+        ;
+}
+
+void TigerIoCounters::RecordClose()
+{
+    m_uCloses.fetch_add(1, std::memory_order_relaxed);
+}
+
+void TigerIoCounters::Snapshot(AkDeviceID in_deviceID, TigerIoDeviceStats &out_stats) const
+{
+    out_stats.deviceID = in_deviceID;
+    out_stats.uOpens = m_uOpens.load(std::memory_order_relaxed);
+    out_stats.uOpenFailures = m_uOpenFailures.load(std::memory_order_relaxed);
+    out_stats.uCloses = m_uCloses.load(std::memory_order_relaxed);
+    out_stats.uReads = m_uReads.load(std::memory_order_relaxed);
+    out_stats.uReadFailures = m_uReadFailures.load(std::memory_order_relaxed);
+    out_stats.uBytesRead = m_uBytesRead.load(std::memory_order_relaxed);
+    out_stats.uDeadlineMisses = m_uDeadlineMisses.load(std::memory_order_relaxed);
+    out_stats.uMaxLatenessUs = m_uMaxLatenessUs.load(std::memory_order_relaxed);
+    for (AkUInt32 i = 0; i < TIGER_IO_LATENCY_BUCKETS; i++)
+    {
+        out_stats.openLatencyUs[i] = m_openLatencyUs[i].load(std::memory_order_relaxed);
+        out_stats.readLatencyUs[i] = m_readLatencyUs[i].load(std::memory_order_relaxed);
+    }
+}
+
+void TigerIoCounters::Reset()
+{
+    m_uOpens.store(0, std::memory_order_relaxed);
+    m_uOpenFailures.store(0, std::memory_order_relaxed);
+    m_uCloses.store(0, std::memory_order_relaxed);
+    m_uReads.store(0, std::memory_order_relaxed);
+    m_uReadFailures.store(0, std::memory_order_relaxed);
+    m_uBytesRead.store(0, std::memory_order_relaxed);
+    m_uDeadlineMisses.store(0, std::memory_order_relaxed);
+    m_uMaxLatenessUs.store(0, std::memory_order_relaxed);
+    for (AkUInt32 i = 0; i < TIGER_IO_LATENCY_BUCKETS; i++)
+    {
+        m_openLatencyUs[i].store(0, std::memory_order_relaxed);
+        m_readLatencyUs[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+AkUInt32 TigerIoCounters::LatencyBucket(AkUInt64 in_uLatencyUs)
+{
+    AkUInt32 uBucket = 0;
+    while (in_uLatencyUs > 0 && uBucket < TIGER_IO_LATENCY_BUCKETS - 1)
+    {
+        in_uLatencyUs >>= 1;
+        uBucket++;
+    }
+    return uBucket;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <stdio.h>
+#include <AK/SoundEngine/Common/AkTypes.h>
+
+// Latency histograms are log2-scaled in microseconds: bucket 0 counts operations under 1us, and
+// bucket i > 0 counts operations in [2^(i-1), 2^i) us. The last bucket also absorbs everything
+// slower (2^18us, ~262ms and up).
+#define TIGER_IO_LATENCY_BUCKETS 20
+
+enum TigerIoTraceLevel
+{
+    TigerIoTraceLevel_None = 0,   // No tracing.
+    TigerIoTraceLevel_Errors = 1, // Failed opens, reads and writes.
+    TigerIoTraceLevel_Files = 2,  // Opens and closes.
+    TigerIoTraceLevel_All = 3,    // Every transfer.
+};
+
+// Snapshot of the counters of one Tiger I/O device.
+struct TigerIoDeviceStats
+{
+    AkDeviceID deviceID;
+    AkUInt64 uOpens;
+    AkUInt64 uOpenFailures;
+    AkUInt64 uCloses;
+    AkUInt64 uReads;
+    AkUInt64 uReadFailures;
+    AkUInt64 uBytesRead;
+    AkUInt64 uDeadlineMisses; // Reads that completed after their AkIoHeuristics::fDeadline.
+    AkUInt64 uMaxLatenessUs;  // How late the latest of those reads completed.
+    AkUInt64 openLatencyUs[TIGER_IO_LATENCY_BUCKETS];
+    AkUInt64 readLatencyUs[TIGER_IO_LATENCY_BUCKETS];
+};
+
+extern std::atomic<AkUInt32> g_tigerIoTraceLevel;
+
+// Traces are only formatted when the current level asks for them, the hot path otherwise only
+// pays for a relaxed load.
+#define TIGER_IO_TRACE(level, ...)                                                    \
+    do                                                                                \
+    {                                                                                 \
+        if (g_tigerIoTraceLevel.load(std::memory_order_relaxed) >= (AkUInt32)(level)) \
+            printf(__VA_ARGS__);                                                      \
+    } while (0)
+
+#if defined(AK_WIN)
+#define TIGER_IO_OSCHAR_FMT "%ls"
+#else
+#define TIGER_IO_OSCHAR_FMT "%s"
+#endif
+
+// Lock-free counters updated by the I/O hooks. Every member is only ever incremented with relaxed
+// atomics, snapshots are therefore not a consistent cut but are cheap to take from any thread.
+class TigerIoCounters
+{
+public:
+    TigerIoCounters() { Reset(); }
+
+    void RecordOpen(AKRESULT in_eResult, AkUInt64 in_uLatencyUs);
+    void RecordRead(AKRESULT in_eResult, AkUInt64 in_uBytes, AkUInt64 in_uLatencyUs);
+    // Counts a deadline miss if a read of in_fDeadlineMs took longer than that.
+    void RecordDeadline(AkUInt64 in_uLatencyUs, AkReal32 in_fDeadlineMs);
+    void RecordClose();
+
+    void Snapshot(AkDeviceID in_deviceID, TigerIoDeviceStats &out_stats) const;
+    void Reset();
+
+private:
+    static AkUInt32 LatencyBucket(AkUInt64 in_uLatencyUs);
+    void RecordDeadlineMiss(AkUInt64 in_uLatenessUs);
+
+    std::atomic<AkUInt64> m_uOpens;
+    std::atomic<AkUInt64> m_uOpenFailures;
+    std::atomic<AkUInt64> m_uCloses;
+    std::atomic<AkUInt64> m_uReads;
+    std::atomic<AkUInt64> m_uReadFailures;
+    std::atomic<AkUInt64> m_uBytesRead;
+    std::atomic<AkUInt64> m_uDeadlineMisses;
+    std::atomic<AkUInt64> m_uMaxLatenessUs;
+    std::atomic<AkUInt64> m_openLatencyUs[TIGER_IO_LATENCY_BUCKETS];
+    std::atomic<AkUInt64> m_readLatencyUs[TIGER_IO_LATENCY_BUCKETS];
+};
+
+// Measures the time elapsed since its construction.
+class TigerIoTimer
+{
+public:
+    TigerIoTimer() : m_start(std::chrono::steady_clock::now()) {}
+
+    AkUInt64 ElapsedUs() const
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_start).count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point m_start;
+};
@@ -0,0 +1,273 @@
+#include "tiger_io_uring.h"
+
+#if defined(__linux__)
+
+#include <algorithm>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+// How long the kernel submission thread keeps polling after the last submission, in ms.
+#define TIGER_URING_SQ_THREAD_IDLE_MS 50
+
+// Missing from the headers of kernels before 5.11.
+#ifndef IORING_FEAT_SQPOLL_NONFIXED
+#define IORING_FEAT_SQPOLL_NONFIXED (1U << 5)
+#endif
+
+static int IoUringSetup(unsigned in_uEntries, struct io_uring_params *io_pParams)
+{
+    return (int)syscall(__NR_io_uring_setup, in_uEntries, io_pParams);
+}
+
+static int IoUringEnter(int in_ringFd, unsigned in_uToSubmit, unsigned in_uMinComplete, unsigned in_uFlags)
+{
+    return (int)syscall(__NR_io_uring_enter, in_ringFd, in_uToSubmit, in_uMinComplete, in_uFlags, NULL, 0);
+}
+
+TigerUring::TigerUring()
+    : m_bStop(false),
+      m_pSqRing(MAP_FAILED), m_uSqRingSize(0), m_pCqRing(MAP_FAILED), m_uCqRingSize(0), m_pSqes((struct io_uring_sqe *)MAP_FAILED), m_uSqesSize(0),
+      m_pfnCompletion(NULL), m_ringFd(-1), m_bSqPoll(false)
+{
+}
+
+bool TigerUring::Init(unsigned in_uQueueDepth, TigerUringCompletion in_pfnCompletion)
+{
+    if (IsActive() || in_uQueueDepth == 0)
+        return false;
+
+    // One more entry than requests, for the NOP that wakes the reaper up in Term. Polling
+    // submissions needs CAP_SYS_ADMIN before Linux 5.11, and only takes registered files there,
+    // retry with plain submissions.
+    if (!SetupRing(in_uQueueDepth + 1, true) && !SetupRing(in_uQueueDepth + 1, false))
+        return false;
+
+    m_pfnCompletion = in_pfnCompletion;
+    m_requests.resize(in_uQueueDepth);
+    m_freeRequests.clear();
+    for (auto &request : m_requests)
+        m_freeRequests.push_back(&request);
+
+    m_bStop = false;
+    m_reaper = std::thread(&TigerUring::ReaperMain, this);
+    return true;
+}
+
+void TigerUring::Term()
+{
+    if (!IsActive())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_submitLock);
+        m_bStop = true;
+        // Wakes the reaper up if it is waiting for completions while none are in flight.
+        PushSqe(IORING_OP_NOP, NULL);
+    }
+    m_reaper.join();
+
+    UnmapRing();
+    m_requests.clear();
+    m_freeRequests.clear();
+}
+
+bool TigerUring::SubmitRead(int in_fd, void *out_pBuffer, size_t in_uSize, uint64_t in_uOffset, void *in_pCookie)
+{
+    if (!IsActive())
+        return false;
+
+    std::lock_guard<std::mutex> lock(m_submitLock);
+    if (m_bStop || m_freeRequests.empty())
+        return false;
+
+    Request *pRequest = m_freeRequests.back();
+    m_freeRequests.pop_back();
+    pRequest->fd = in_fd;
+    pRequest->iov.iov_base = out_pBuffer;
+    pRequest->iov.iov_len = in_uSize;
+    pRequest->uOffset = in_uOffset;
+    pRequest->uSize = in_uSize;
+    pRequest->uDone = 0;
+    pRequest->pCookie = in_pCookie;
+
+    PushSqe(IORING_OP_READV, pRequest);
+    return true;
+}
+
+bool TigerUring::SetupRing(unsigned in_uQueueDepth, bool in_bSqPoll)
+{
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    if (in_bSqPoll)
+    {
+        params.flags = IORING_SETUP_SQPOLL;
+        params.sq_thread_idle = TIGER_URING_SQ_THREAD_IDLE_MS;
+    }
+
+    int ringFd = IoUringSetup(in_uQueueDepth, &params);
+    if (ringFd < 0)
+        return false;
+    if (in_bSqPoll && !(params.features & IORING_FEAT_SQPOLL_NONFIXED))
+    {
+        // Reads of plain fds would all complete with -EBADF.
+        close(ringFd);
+        return false;
+    }
+
+    m_uSqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    m_uCqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+        m_uSqRingSize = m_uCqRingSize = std::max(m_uSqRingSize, m_uCqRingSize);
+    m_uSqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+
+    m_pSqRing = mmap(NULL, m_uSqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+        m_pCqRing = m_pSqRing;
+    else if (m_pSqRing != MAP_FAILED)
+        m_pCqRing = mmap(NULL, m_uCqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_CQ_RING);
+    m_pSqes = (struct io_uring_sqe *)mmap(NULL, m_uSqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES);
+
+    m_ringFd = ringFd;
+    if (m_pSqRing == MAP_FAILED || m_pCqRing == MAP_FAILED || m_pSqes == MAP_FAILED)
+    {
+        UnmapRing();
+        return false;
+    }
+
+    uint8_t *pSq = (uint8_t *)m_pSqRing;
+    m_pSqHead = (unsigned *)(pSq + params.sq_off.head);
+    m_pSqTail = (unsigned *)(pSq + params.sq_off.tail);
+    m_pSqMask = (unsigned *)(pSq + params.sq_off.ring_mask);
+    m_pSqFlags = (unsigned *)(pSq + params.sq_off.flags);
+    m_pSqArray = (unsigned *)(pSq + params.sq_off.array);
+
+    uint8_t *pCq = (uint8_t *)m_pCqRing;
+    m_pCqHead = (unsigned *)(pCq + params.cq_off.head);
+    m_pCqTail = (unsigned *)(pCq + params.cq_off.tail);
+    m_pCqMask = (unsigned *)(pCq + params.cq_off.ring_mask);
+    m_pCqes = (struct io_uring_cqe *)(pCq + params.cq_off.cqes);
+
+    m_bSqPoll = in_bSqPoll;
+    return true;
+}
+
+void TigerUring::UnmapRing()
+{
+    if (m_pSqes != MAP_FAILED)
+        munmap(m_pSqes, m_uSqesSize);
+    if (m_pCqRing != MAP_FAILED && m_pCqRing != m_pSqRing)
+        munmap(m_pCqRing, m_uCqRingSize);
+    if (m_pSqRing != MAP_FAILED)
+        munmap(m_pSqRing, m_uSqRingSize);
+    m_pSqRing = m_pCqRing = MAP_FAILED;
+    m_pSqes = (struct io_uring_sqe *)MAP_FAILED;
+
+    if (m_ringFd >= 0)
+        close(m_ringFd);
+    m_ringFd = -1;
+    m_bSqPoll = false;
+}
+
+void TigerUring::PushSqe(uint8_t in_opcode, Request *in_pRequest)
+{
+    // There are more submission entries than requests, and a request never has more than one
+    // entry queued, so there is always room.
+    unsigned uTail = *m_pSqTail;
+    unsigned uIndex = uTail & *m_pSqMask;
+
+    struct io_uring_sqe *pSqe = &m_pSqes[uIndex];
+    memset(pSqe, 0, sizeof(*pSqe));
+    pSqe->opcode = in_opcode;
+    pSqe->user_data = (uint64_t)(uintptr_t)in_pRequest;
+    if (in_pRequest)
+    {
+        pSqe->fd = in_pRequest->fd;
+        pSqe->addr = (uint64_t)(uintptr_t)&in_pRequest->iov;
+        pSqe->len = 1;
+        pSqe->off = in_pRequest->uOffset + in_pRequest->uDone;
+    }
+    m_pSqArray[uIndex] = uIndex;
+    __atomic_store_n(m_pSqTail, uTail + 1, __ATOMIC_RELEASE);
+
+    if (!m_bSqPoll)
+        IoUringEnter(m_ringFd, 1, 0, 0);
+    else
+    {
+        // Orders the tail store before the flags load (io_uring_smp_mb in liburing): otherwise a
+        // poller going to sleep meanwhile could be missed, leaving the entry until the next one.
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        if (__atomic_load_n(m_pSqFlags, __ATOMIC_RELAXED) & IORING_SQ_NEED_WAKEUP)
+            IoUringEnter(m_ringFd, 0, 0, IORING_ENTER_SQ_WAKEUP);
+    }
+}
+
+void TigerUring::ReaperMain()
+{
+    for (;;)
+    {
+        unsigned uHead = *m_pCqHead;
+        unsigned uTail = __atomic_load_n(m_pCqTail, __ATOMIC_ACQUIRE);
+        if (uHead == uTail)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_submitLock);
+                if (m_bStop && m_freeRequests.size() == m_requests.size())
+                    return;
+            }
+            int iResult = IoUringEnter(m_ringFd, 0, 1, IORING_ENTER_GETEVENTS);
+            if (iResult < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY)
+                return;
+            continue;
+        }
+
+        for (; uHead != uTail; uHead++)
+        {
+            const struct io_uring_cqe &cqe = m_pCqes[uHead & *m_pCqMask];
+            Request *pRequest = (Request *)(uintptr_t)cqe.user_data;
+            if (!pRequest)
+                continue;
+
+            if (cqe.res > 0 && pRequest->uDone + cqe.res < pRequest->uSize)
+            {
+                // Short read, queue the remainder.
+                pRequest->uDone += cqe.res;
+                pRequest->iov.iov_base = (uint8_t *)pRequest->iov.iov_base + cqe.res;
+                pRequest->iov.iov_len -= cqe.res;
+                std::lock_guard<std::mutex> lock(m_submitLock);
+                PushSqe(IORING_OP_READV, pRequest);
+                continue;
+            }
+
+            int64_t iResult = cqe.res < 0 ? (int64_t)cqe.res : (int64_t)(pRequest->uDone + cqe.res);
+            void *pCookie = pRequest->pCookie;
+            {
+                std::lock_guard<std::mutex> lock(m_submitLock);
+                m_freeRequests.push_back(pRequest);
+            }
+            m_pfnCompletion(pCookie, iResult);
+        }
+        __atomic_store_n(m_pCqHead, uHead, __ATOMIC_RELEASE);
+    }
+}
+
+#else
+
+TigerUring::TigerUring() : m_pfnCompletion(NULL), m_ringFd(-1), m_bSqPoll(false) {}
+
+bool TigerUring::Init(unsigned in_uQueueDepth, TigerUringCompletion in_pfnCompletion)
+{
+    return false;
+}
+
+void TigerUring::Term() {}
+
+bool TigerUring::SubmitRead(int in_fd, void *out_pBuffer, size_t in_uSize, uint64_t in_uOffset, void *in_pCookie)
+{
+    return false;
+}
+
+#endif
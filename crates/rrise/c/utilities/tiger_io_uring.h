@@ -0,0 +1,92 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__linux__)
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <sys/uio.h>
+#endif
+
+// Called on the reaper thread when a read completes. in_iResult is the number of bytes read
+// (which is less than requested only at end of file) or a negative errno.
+typedef void (*TigerUringCompletion)(void *in_pCookie, int64_t in_iResult);
+
+// Minimal io_uring read queue for loose files, talking to the kernel through the raw syscalls
+// so it doesn't depend on liburing.
+//
+// The ring is set up with a kernel submission thread (IORING_SETUP_SQPOLL) when allowed, in which
+// case queuing a read is a plain memory write. Otherwise each SubmitRead costs one io_uring_enter.
+// Either way, completions are reaped in batches by a single thread that only sleeps in the kernel
+// when none are pending.
+//
+// On platforms or kernels without io_uring, Init fails and the caller keeps its regular path.
+class TigerUring
+{
+public:
+    TigerUring();
+    ~TigerUring() { Term(); }
+
+    // Sets up a ring allowing in_uQueueDepth reads in flight. Returns false if io_uring is not
+    // available, in which case every SubmitRead fails.
+    bool Init(unsigned in_uQueueDepth, TigerUringCompletion in_pfnCompletion);
+
+    // Waits for the reads in flight, then tears the ring down.
+    void Term();
+
+    bool IsActive() const { return m_ringFd >= 0; }
+    bool UsesKernelSubmissionThread() const { return m_bSqPoll; }
+
+    // Queues a read, completed through the callback given to Init. Returns false if it could not
+    // be queued (ring inactive or full): the caller must then do the read itself.
+    bool SubmitRead(int in_fd, void *out_pBuffer, size_t in_uSize, uint64_t in_uOffset, void *in_pCookie);
+
+private:
+#if defined(__linux__)
+    struct Request
+    {
+        int fd;
+        struct iovec iov;
+        uint64_t uOffset;
+        size_t uSize;
+        size_t uDone;
+        void *pCookie;
+    };
+
+    bool SetupRing(unsigned in_uQueueDepth, bool in_bSqPoll);
+    void UnmapRing();
+    // m_submitLock must be held.
+    void PushSqe(uint8_t in_opcode, Request *in_pRequest);
+    void ReaperMain();
+
+    std::mutex m_submitLock;
+    std::vector<Request> m_requests;
+    std::vector<Request *> m_freeRequests;
+    std::thread m_reaper;
+    bool m_bStop;
+
+    // Ring mappings, see io_uring_setup(2).
+    void *m_pSqRing;
+    size_t m_uSqRingSize;
+    void *m_pCqRing;
+    size_t m_uCqRingSize;
+    struct io_uring_sqe *m_pSqes;
+    size_t m_uSqesSize;
+
+    unsigned *m_pSqHead;
+    unsigned *m_pSqTail;
+    unsigned *m_pSqMask;
+    unsigned *m_pSqFlags;
+    unsigned *m_pSqArray;
+    unsigned *m_pCqHead;
+    unsigned *m_pCqTail;
+    unsigned *m_pCqMask;
+    struct io_uring_cqe *m_pCqes;
+#endif
+
+    TigerUringCompletion m_pfnCompletion;
+    int m_ringFd;
+    bool m_bSqPoll;
+};
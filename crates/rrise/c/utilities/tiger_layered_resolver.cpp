@@ -0,0 +1,161 @@
+#include "tiger_layered_resolver.h"
+
+void TigerLayeredResolver::AddLayer(AK::StreamMgr::IAkFileLocationResolver *in_pResolver)
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    if (m_layers.empty())
+        AK::StreamMgr::AddLanguageChangeObserver(&TigerLayeredResolver::OnLanguageChange, this);
+
+    Layer layer;
+    layer.pResolver = in_pResolver;
+    m_layers.push_back(layer);
+}
+
+void TigerLayeredResolver::RemoveAllLayers()
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    if (!m_layers.empty())
+        AK::StreamMgr::RemoveLanguageChangeObserver(this);
+    m_layers.clear();
+}
+
+bool TigerLayeredResolver::HasLayers()
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    return !m_layers.empty();
+}
+
+void TigerLayeredResolver::ClearNegativeCache()
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    for (auto &layer : m_layers)
+    {
+        layer.missingIDs.clear();
+        layer.missingNames.clear();
+    }
+}
+
+AkUInt64 TigerLayeredResolver::GetNegativeHits()
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    return m_uNegativeHits;
+}
+
+AKRESULT TigerLayeredResolver::Open(
+    const AkOSChar *in_pszFileName, ///< File name.
+    AkOpenMode in_eOpenMode,        ///< Open mode.
+    AkFileSystemFlags *in_pFlags,   ///< Special flags. Can pass NULL.
+    bool &io_bSyncOpen,             ///< If true, the file must be opened synchronously. Otherwise it is left at the File Location Resolver's discretion. Return false if Open needs to be deferred.
+    AkFileDesc &out_fileDesc        ///< Returned file descriptor.
+)
+{
+    // Files that are written are created by the first layer, they can't be missing.
+    bool bCacheable = in_eOpenMode == AK_OpenModeRead;
+    std::basic_string<AkOSChar> key = NameKey(in_pszFileName, in_pFlags);
+    bool bSyncOpen = io_bSyncOpen;
+
+    for (size_t i = 0;; i++)
+    {
+        AK::StreamMgr::IAkFileLocationResolver *pResolver;
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            if (i >= m_layers.size())
+                return AK_FileNotFound;
+            if (bCacheable && m_layers[i].missingNames.count(key))
+            {
+                m_uNegativeHits++;
+                continue;
+            }
+            pResolver = m_layers[i].pResolver;
+        }
+
+        io_bSyncOpen = bSyncOpen;
+        AKRESULT eResult = pResolver->Open(in_pszFileName, in_eOpenMode, in_pFlags, io_bSyncOpen, out_fileDesc);
+        if (eResult != AK_FileNotFound)
+            return eResult;
+
+        if (bCacheable)
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            if (i < m_layers.size())
+            {
+                auto &missingNames = m_layers[i].missingNames;
+                if (missingNames.size() >= TIGER_RESOLVER_NEGATIVE_CACHE_MAX)
+                    missingNames.clear();
+                missingNames.insert(key);
+            }
+        }
+    }
+}
+
+AKRESULT TigerLayeredResolver::Open(
+    AkFileID in_fileID,           ///< File ID.
+    AkOpenMode in_eOpenMode,      ///< Open mode.
+    AkFileSystemFlags *in_pFlags, ///< Special flags. Can pass NULL.
+    bool &io_bSyncOpen,           ///< If true, the file must be opened synchronously. Otherwise it is left at the File Location Resolver's discretion. Return false if Open needs to be deferred.
+    AkFileDesc &out_fileDesc      ///< Returned file descriptor.
+)
+{
+    bool bCacheable = in_eOpenMode == AK_OpenModeRead;
+    AkUInt64 key = IDKey(in_fileID, in_pFlags);
+    bool bSyncOpen = io_bSyncOpen;
+
+    for (size_t i = 0;; i++)
+    {
+        AK::StreamMgr::IAkFileLocationResolver *pResolver;
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            if (i >= m_layers.size())
+                return AK_FileNotFound;
+            if (bCacheable && m_layers[i].missingIDs.count(key))
+            {
+                m_uNegativeHits++;
+                continue;
+            }
+            pResolver = m_layers[i].pResolver;
+        }
+
+        io_bSyncOpen = bSyncOpen;
+        AKRESULT eResult = pResolver->Open(in_fileID, in_eOpenMode, in_pFlags, io_bSyncOpen, out_fileDesc);
+        if (eResult != AK_FileNotFound)
+            return eResult;
+
+        if (bCacheable)
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            if (i < m_layers.size())
+            {
+                auto &missingIDs = m_layers[i].missingIDs;
+                if (missingIDs.size() >= TIGER_RESOLVER_NEGATIVE_CACHE_MAX)
+                    missingIDs.clear();
+                missingIDs.insert(key);
+            }
+        }
+    }
+}
+
+AkUInt64 TigerLayeredResolver::IDKey(AkFileID in_fileID, const AkFileSystemFlags *in_pFlags)
+{
+    AkUInt64 key = in_fileID;
+    if (in_pFlags)
+    {
+        // File ID in bits 0-31, codec in 32-62 and the language flag in 63. Codec IDs are small,
+        // the top bit of one is dropped rather than let it alias the flag.
+        key |= (AkUInt64)(in_pFlags->uCodecID & 0x7FFFFFFF) << 32;
+        key |= (AkUInt64)in_pFlags->bIsLanguageSpecific << 63;
+    }
+    return key;
+}
+
+std::basic_string<AkOSChar> TigerLayeredResolver::NameKey(const AkOSChar *in_pszFileName, const AkFileSystemFlags *in_pFlags)
+{
+    std::basic_string<AkOSChar> key(in_pszFileName);
+    if (in_pFlags && in_pFlags->bIsLanguageSpecific)
+        key.insert(key.begin(), (AkOSChar)'*');
+    return key;
+}
+
+void TigerLayeredResolver::OnLanguageChange(const AkOSChar *const in_pLanguageName, void *in_pCookie)
+{
+    ((TigerLayeredResolver *)in_pCookie)->ClearNegativeCache();
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include <AK/SoundEngine/Common/AkStreamMgrModule.h>
+
+// A layer stops remembering missing files past this many, and starts over.
+#define TIGER_RESOLVER_NEGATIVE_CACHE_MAX 65536
+
+// File Location Resolver chaining other resolvers (typically the Tiger package hook, then the
+// default file-package device and its base paths). Each Open is tried on the layers in the order
+// they were added, until one of them finds the file.
+//
+// Files a layer reported as not found (AK_FileNotFound) are remembered per layer, so later opens
+// of missing media skip straight past that layer instead of looking the file up again. The cache
+// is cleared when the language changes (language-specific files resolve differently) and can be
+// cleared explicitly, e.g. when the packages change.
+class TigerLayeredResolver : public AK::StreamMgr::IAkFileLocationResolver
+{
+public:
+    TigerLayeredResolver() : m_uNegativeHits(0) {}
+
+    void AddLayer(AK::StreamMgr::IAkFileLocationResolver *in_pResolver);
+    void RemoveAllLayers();
+    bool HasLayers();
+
+    void ClearNegativeCache();
+
+    // Number of layer lookups skipped thanks to the negative cache.
+    AkUInt64 GetNegativeHits();
+
+    virtual AKRESULT Open(
+        const AkOSChar *in_pszFileName, // File name.
+        AkOpenMode in_eOpenMode,        // Open mode.
+        AkFileSystemFlags *in_pFlags,   // Special flags. Can pass NULL.
+        bool &io_bSyncOpen,             // If true, the file must be opened synchronously. Otherwise it is left at the File Location Resolver's discretion. Return false if Open needs to be deferred.
+        AkFileDesc &out_fileDesc        // Returned file descriptor.
+    );
+
+    virtual AKRESULT Open(
+        AkFileID in_fileID,           // File ID.
+        AkOpenMode in_eOpenMode,      // Open mode.
+        AkFileSystemFlags *in_pFlags, // Special flags. Can pass NULL.
+        bool &io_bSyncOpen,           // If true, the file must be opened synchronously. Otherwise it is left at the File Location Resolver's discretion. Return false if Open needs to be deferred.
+        AkFileDesc &out_fileDesc      // Returned file descriptor.
+    );
+
+private:
+    struct Layer
+    {
+        AK::StreamMgr::IAkFileLocationResolver *pResolver;
+        // Keys of files this layer didn't find, see IDKey and NameKey.
+        std::unordered_set<AkUInt64> missingIDs;
+        std::unordered_set<std::basic_string<AkOSChar>> missingNames;
+    };
+
+    // The same ID or name may resolve to another file depending on these flags.
+    static AkUInt64 IDKey(AkFileID in_fileID, const AkFileSystemFlags *in_pFlags);
+    static std::basic_string<AkOSChar> NameKey(const AkOSChar *in_pszFileName, const AkFileSystemFlags *in_pFlags);
+
+    static void OnLanguageChange(const AkOSChar *const in_pLanguageName, void *in_pCookie);
+
+    std::mutex m_lock;
+    std::vector<Layer> m_layers;
+    AkUInt64 m_uNegativeHits;
+};
@@ -0,0 +1,74 @@
+#include "tiger_package_file_table.h"
+
+#define GENERATION_MASK 0x7FFFFFFF
+
+static inline AkUInt64 MakeHandle(AkUInt32 in_uIndex, AkUInt32 in_uGeneration)
+{
+    return ((AkUInt64)in_uGeneration << 32) | in_uIndex;
+}
+
+AkUInt64 TigerPackageFileTable::Insert(const TigerPackageFile &in_file)
+{
+    AkUInt32 uShard = m_uNextShard.fetch_add(1, std::memory_order_relaxed) % TIGER_PACKAGE_FILE_TABLE_SHARDS;
+    Shard &shard = m_shards[uShard];
+
+    std::lock_guard<std::mutex> lock(shard.lock);
+    AkUInt32 uLocal;
+    if (!shard.freeSlots.empty())
+    {
+        uLocal = shard.freeSlots.back();
+        shard.freeSlots.pop_back();
+    }
+    else
+    {
+        uLocal = (AkUInt32)shard.slots.size();
+        shard.slots.push_back(Slot{1, false, {}});
+    }
+
+    Slot &slot = shard.slots[uLocal];
+    slot.bUsed = true;
+    slot.file = in_file;
+    return MakeHandle(uLocal * TIGER_PACKAGE_FILE_TABLE_SHARDS + uShard, slot.uGeneration);
+}
+
+bool TigerPackageFileTable::Get(AkUInt64 in_uHandle, TigerPackageFile &out_file)
+{
+    Shard &shard = ShardOf(in_uHandle);
+    std::lock_guard<std::mutex> lock(shard.lock);
+    Slot *pSlot = Find(shard, in_uHandle);
+    if (!pSlot)
+        return false;
+    out_file = pSlot->file;
+    return true;
+}
+
+bool TigerPackageFileTable::Remove(AkUInt64 in_uHandle, TigerPackageFile &out_file)
+{
+    Shard &shard = ShardOf(in_uHandle);
+    std::lock_guard<std::mutex> lock(shard.lock);
+    Slot *pSlot = Find(shard, in_uHandle);
+    if (!pSlot)
+        return false;
+
+    out_file = pSlot->file;
+    pSlot->bUsed = false;
+    // Generation 0 is skipped so that no handle is ever 0.
+    pSlot->uGeneration = (pSlot->uGeneration + 1) & GENERATION_MASK;
+    if (!pSlot->uGeneration)
+        pSlot->uGeneration = 1;
+    shard.freeSlots.push_back((AkUInt32)(pSlot - shard.slots.data()));
+    return true;
+}
+
+TigerPackageFileTable::Slot *TigerPackageFileTable::Find(Shard &in_shard, AkUInt64 in_uHandle)
+{
+    AkUInt32 uLocal = (AkUInt32)in_uHandle / TIGER_PACKAGE_FILE_TABLE_SHARDS;
+    AkUInt32 uGeneration = (AkUInt32)(in_uHandle >> 32);
+    if (uLocal >= in_shard.slots.size())
+        return NULL;
+
+    Slot &slot = in_shard.slots[uLocal];
+    if (!slot.bUsed || slot.uGeneration != uGeneration)
+        return NULL;
+    return &slot;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <AK/SoundEngine/Common/AkTypes.h>
+#include "tiger_file_cache.h"
+
+// Number of independently locked shards of TigerPackageFileTable.
+#define TIGER_PACKAGE_FILE_TABLE_SHARDS 16
+
+// A package file opened through Open(AkFileID). Files that are streamed are not materialized:
+// `buffer.data` is null and reads are forwarded to the package as ranged reads instead, unless
+// the file cache holds them already. Other files are borrowed from the file cache until Close.
+struct TigerPackageFile
+{
+    AkFileID fileID;
+    TigerFileBuffer buffer;
+    // Block size the Stream Manager reads the file in while it isn't materialized, see
+    // TigerPackageIo::GetBlockSize.
+    AkUInt32 uBlockSize;
+};
+
+// Open package files of TigerPackageIo, by handle.
+//
+// Slots are spread round-robin over shards that each have their own lock, so I/O threads reading
+// different files rarely contend. A handle is the index of its slot in the low 32 bits and the
+// generation of the slot in the next 31: closing a file bumps the generation of its slot, and a
+// handle used after Close (or twice closed) no longer matches and is rejected rather than
+// reaching whichever file reused the slot. Handles are never 0 and leave bit 63 free.
+class TigerPackageFileTable
+{
+public:
+    TigerPackageFileTable() : m_uNextShard(0) {}
+
+    AkUInt64 Insert(const TigerPackageFile &in_file);
+
+    // Copies the file of in_uHandle, false if the handle is stale or was never issued.
+    bool Get(AkUInt64 in_uHandle, TigerPackageFile &out_file);
+
+    // Frees the slot of in_uHandle and returns the file it held.
+    bool Remove(AkUInt64 in_uHandle, TigerPackageFile &out_file);
+
+private:
+    struct Slot
+    {
+        AkUInt32 uGeneration;
+        bool bUsed;
+        TigerPackageFile file;
+    };
+
+    // One per cache line, so threads locking neighbouring shards don't share it.
+    struct alignas(64) Shard
+    {
+        std::mutex lock;
+        std::vector<Slot> slots;
+        std::vector<AkUInt32> freeSlots;
+    };
+
+    // The slot of in_uHandle if it is current, NULL otherwise. The lock of its shard must be held.
+    static Slot *Find(Shard &in_shard, AkUInt64 in_uHandle);
+    Shard &ShardOf(AkUInt64 in_uHandle) { return m_shards[(AkUInt32)in_uHandle % TIGER_PACKAGE_FILE_TABLE_SHARDS]; }
+
+    Shard m_shards[TIGER_PACKAGE_FILE_TABLE_SHARDS];
+    std::atomic<AkUInt32> m_uNextShard;
+};
@@ -0,0 +1,63 @@
+#include <string.h>
+#include "tiger_read_recorder.h"
+
+void TigerReadRecorder::Start(AkUInt32 in_uDurationMs)
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    m_reads.clear();
+    m_start = Clock::now();
+    m_end = m_start + std::chrono::milliseconds(in_uDurationMs);
+    m_bRecording.store(true, std::memory_order_relaxed);
+}
+
+void TigerReadRecorder::Stop()
+{
+    m_bRecording.store(false, std::memory_order_relaxed);
+}
+
+void TigerReadRecorder::Record(AkFileID in_fileID, AkUInt64 in_uOffset, AkUInt32 in_uSize)
+{
+    if (!m_bRecording.load(std::memory_order_relaxed))
+        return;
+
+    Clock::time_point now = Clock::now();
+    std::lock_guard<std::mutex> lock(m_lock);
+    if (now >= m_end)
+    {
+        m_bRecording.store(false, std::memory_order_relaxed);
+        return;
+    }
+
+    // Streams read their file window after window, one range per file and stretch of playback is
+    // enough. Other streams' reads usually interleave, so look back a little.
+    size_t uLookBack = AkMin(m_reads.size(), (size_t)8);
+    for (size_t i = m_reads.size(); i > m_reads.size() - uLookBack; i--)
+    {
+        TigerRecordedRead &read = m_reads[i - 1];
+        if (read.fileID == in_fileID && read.uOffset + read.uSize == in_uOffset)
+        {
+            read.uSize += in_uSize;
+            return;
+        }
+    }
+
+    if (m_reads.size() >= TIGER_READ_RECORDER_MAX_READS)
+        return;
+
+    TigerRecordedRead read;
+    memset(&read, 0, sizeof(read));
+    read.fileID = in_fileID;
+    read.uSize = in_uSize;
+    read.uOffset = in_uOffset;
+    read.uTimeMs = (AkUInt32)std::chrono::duration_cast<std::chrono::milliseconds>(now - m_start).count();
+    m_reads.push_back(read);
+}
+
+AkUInt32 TigerReadRecorder::GetReads(TigerRecordedRead *out_pReads, AkUInt32 in_uMaxReads)
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    AkUInt32 uCount = AkMin((AkUInt32)m_reads.size(), in_uMaxReads);
+    if (uCount)
+        memcpy(out_pReads, m_reads.data(), uCount * sizeof(TigerRecordedRead));
+    return (AkUInt32)m_reads.size();
+}
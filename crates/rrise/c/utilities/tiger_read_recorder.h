@@ -0,0 +1,48 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <vector>
+#include <AK/SoundEngine/Common/AkTypes.h>
+
+// Reads kept by one recording at most, later ones are dropped.
+#define TIGER_READ_RECORDER_MAX_READS 16384
+
+// A range of a package file read by TigerPackageIo. Consecutive reads of the same file are
+// merged into one range.
+struct TigerRecordedRead
+{
+    AkFileID fileID;
+    AkUInt32 uSize;
+    AkUInt64 uOffset;
+    AkUInt32 uTimeMs; // Since the recording started, at the first read of the range.
+};
+
+// Records the package file reads of TigerPackageIo during a window of time, typically the first
+// seconds of playback after a bank is loaded, so that the next load of the bank can prefetch the
+// same files before anything plays (see prefetch_manifest on the Rust side).
+class TigerReadRecorder
+{
+public:
+    TigerReadRecorder() : m_bRecording(false) {}
+
+    // Drops the reads recorded so far and records the ones of the next in_uDurationMs.
+    void Start(AkUInt32 in_uDurationMs);
+    void Stop();
+
+    // Called for every read of a package file. Only a relaxed load while not recording.
+    void Record(AkFileID in_fileID, AkUInt64 in_uOffset, AkUInt32 in_uSize);
+
+    // Copies up to in_uMaxReads of the reads recorded, in order, and returns how many there are.
+    AkUInt32 GetReads(TigerRecordedRead *out_pReads, AkUInt32 in_uMaxReads);
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    std::mutex m_lock;
+    std::atomic<bool> m_bRecording;
+    Clock::time_point m_start;
+    Clock::time_point m_end;
+    std::vector<TigerRecordedRead> m_reads;
+};
@@ -0,0 +1,161 @@
+#include "tiger_stream_context.h"
+
+std::mutex TigerStreamContext::s_contextsLock;
+std::unordered_set<TigerStreamContext *> TigerStreamContext::s_contexts;
+
+AKRESULT TigerStreamContext::Init(const AkDeviceSettings &in_deviceSettings, AkUInt32 in_uNumWorkers, AkUInt32 in_uUringQueueDepth, bool in_bDirectIO, const void *in_pFileSource)
+{
+    if (m_bInitialized)
+        return AK_Fail;
+
+    m_bDeferred = in_uNumWorkers > 0;
+    m_bDirectIO = in_bDirectIO;
+
+    AKRESULT eResult;
+    if (m_bDeferred)
+    {
+        m_deferred.SetDirectIO(in_bDirectIO);
+        m_deferred.SetFileSource(in_pFileSource);
+        eResult = m_deferred.Init(in_deviceSettings, in_uNumWorkers, in_uUringQueueDepth);
+    }
+    else
+    {
+        m_blocking.SetDirectIO(in_bDirectIO);
+        m_blocking.SetFileSource(in_pFileSource);
+        eResult = m_blocking.Init(in_deviceSettings);
+    }
+    if (eResult != AK_Success)
+        return eResult;
+
+    std::lock_guard<std::mutex> lock(s_contextsLock);
+    s_contexts.insert(this);
+    m_bInitialized = true;
+    return AK_Success;
+}
+
+void TigerStreamContext::Term()
+{
+    {
+        std::lock_guard<std::mutex> lock(s_contextsLock);
+        s_contexts.erase(this);
+    }
+
+    if (m_bDeferred)
+        m_deferred.Term();
+    else
+        m_blocking.Term();
+    m_bInitialized = false;
+}
+
+AKRESULT TigerStreamContext::AddDevice(TigerDeviceClass in_eClass, const AkDeviceSettings &in_deviceSettings)
+{
+    AkDeviceSettings settings = in_deviceSettings;
+    if (m_bDirectIO)
+        settings.uIOMemoryAlignment = AkMax(settings.uIOMemoryAlignment, (AkUInt32)TIGER_DIRECT_IO_DEFAULT_ALIGNMENT);
+
+    if (m_bDeferred)
+    {
+        settings.uSchedulerTypeFlags = AK_SCHEDULER_DEFERRED_LINED_UP;
+        return m_deferred.AddDevice(in_eClass, settings);
+    }
+    settings.uSchedulerTypeFlags = AK_SCHEDULER_BLOCKING;
+    return m_blocking.AddDevice(in_eClass, settings);
+}
+
+AK::StreamMgr::IAkFileLocationResolver *TigerStreamContext::GetResolver()
+{
+    if (m_bDeferred)
+        return &m_deferred;
+    return &m_blocking;
+}
+
+AKRESULT TigerStreamContext::OpenStd(AkFileID in_fileID, bool in_bStreamed, AK::IAkStdStream *&out_pStream)
+{
+    out_pStream = NULL;
+    if (!m_bInitialized || !AK::IAkStreamMgr::Get())
+        return AK_Fail;
+
+    // The context travels in the custom parameter, for TigerContextResolver to find it.
+    AkFileSystemFlags flags(AKCOMPANYID_AUDIOKINETIC, in_bStreamed ? AKCODECID_VORBIS : AKCODECID_BANK, sizeof(TigerStreamContext *), this, false, in_bStreamed, in_fileID);
+    return AK::IAkStreamMgr::Get()->CreateStd(in_fileID, &flags, AK_OpenModeRead, out_pStream, true);
+}
+
+void TigerStreamContext::SetWriteBehind(TigerWriteBehindIo *in_pWriteBehind)
+{
+    m_blocking.SetWriteBehind(in_pWriteBehind);
+    m_deferred.SetWriteBehind(in_pWriteBehind);
+}
+
+void TigerStreamContext::GetIoStats(TigerDeviceClass in_eClass, TigerIoDeviceStats &out_stats)
+{
+    if (m_bDeferred)
+        m_deferred.GetIoStats(in_eClass, out_stats);
+    else
+        m_blocking.GetIoStats(in_eClass, out_stats);
+}
+
+void TigerStreamContext::ResetIoStats()
+{
+    if (m_bDeferred)
+        m_deferred.ResetIoStats();
+    else
+        m_blocking.ResetIoStats();
+}
+
+TigerStreamContext *TigerStreamContext::FromFlags(const AkFileSystemFlags *in_pFlags)
+{
+    if (!in_pFlags || !in_pFlags->pCustomParam || in_pFlags->uCustomParamSize != sizeof(TigerStreamContext *))
+        return NULL;
+
+    TigerStreamContext *pContext = (TigerStreamContext *)in_pFlags->pCustomParam;
+    std::lock_guard<std::mutex> lock(s_contextsLock);
+    return s_contexts.count(pContext) ? pContext : NULL;
+}
+
+void TigerContextResolver::Install()
+{
+    if (!AK::StreamMgr::GetFileLocationResolver())
+        AK::StreamMgr::SetFileLocationResolver(this);
+}
+
+void TigerContextResolver::Uninstall()
+{
+    if (AK::StreamMgr::GetFileLocationResolver() == this)
+        AK::StreamMgr::SetFileLocationResolver(NULL);
+}
+
+AK::StreamMgr::IAkFileLocationResolver *TigerContextResolver::Resolve(const AkFileSystemFlags *in_pFlags)
+{
+    TigerStreamContext *pContext = TigerStreamContext::FromFlags(in_pFlags);
+    if (pContext)
+        return pContext->GetResolver();
+    return m_pDefault;
+}
+
+AKRESULT TigerContextResolver::Open(
+    const AkOSChar *in_pszFileName, ///< File name.
+    AkOpenMode in_eOpenMode,        ///< Open mode.
+    AkFileSystemFlags *in_pFlags,   ///< Special flags. Can pass NULL.
+    bool &io_bSyncOpen,             ///< If true, the file must be opened synchronously. Otherwise it is left at the File Location Resolver's discretion. Return false if Open needs to be deferred.
+    AkFileDesc &out_fileDesc        ///< Returned file descriptor.
+)
+{
+    AK::StreamMgr::IAkFileLocationResolver *pResolver = Resolve(in_pFlags);
+    if (!pResolver)
+        return AK_FileNotFound;
+    return pResolver->Open(in_pszFileName, in_eOpenMode, in_pFlags, io_bSyncOpen, out_fileDesc);
+}
+
+AKRESULT TigerContextResolver::Open(
+    AkFileID in_fileID,           ///< File ID.
+    AkOpenMode in_eOpenMode,      ///< Open mode.
+    AkFileSystemFlags *in_pFlags, ///< Special flags. Can pass NULL.
+    bool &io_bSyncOpen,           ///< If true, the file must be opened synchronously. Otherwise it is left at the File Location Resolver's discretion. Return false if Open needs to be deferred.
+    AkFileDesc &out_fileDesc      ///< Returned file descriptor.
+)
+{
+    AK::StreamMgr::IAkFileLocationResolver *pResolver = Resolve(in_pFlags);
+    if (!pResolver)
+        return AK_FileNotFound;
+    return pResolver->Open(in_fileID, in_eOpenMode, in_pFlags, io_bSyncOpen, out_fileDesc);
+}
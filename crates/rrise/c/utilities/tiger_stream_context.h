@@ -0,0 +1,105 @@
+#pragma once
+
+#include <mutex>
+#include <unordered_set>
+#include <AK/SoundEngine/Common/AkStreamMgrModule.h>
+#include "tiger_io_hook.h"
+#include "tiger_io_hook_deferred.h"
+
+// An independent configuration of the Tiger I/O stack: its own hook (blocking or deferred), its
+// own Stream Manager devices, file cache, counters and file source.
+//
+// The Stream Manager itself is a singleton, and so is its File Location Resolver: every context
+// shares TigerContextResolver, which hands each open to the context it was issued for (see
+// OpenStd), or to its default resolver. Several contexts can thus serve their own package sets
+// side by side, e.g. in test harnesses and batch tools.
+class TigerStreamContext
+{
+public:
+    TigerStreamContext() : m_bDeferred(false), m_bDirectIO(false), m_bInitialized(false) {}
+
+    // in_uNumWorkers is 0 for a blocking hook, otherwise the number of workers of a deferred one
+    // (see TigerPackageIoDeferred::Init). The scheduler type of in_deviceSettings must match.
+    // in_pFileSource is the file source of the hook, see TigerPackageIo::SetFileSource.
+    AKRESULT Init(const AkDeviceSettings &in_deviceSettings, AkUInt32 in_uNumWorkers, AkUInt32 in_uUringQueueDepth, bool in_bDirectIO, const void *in_pFileSource);
+
+    // Closes the devices of the context. Its streams must have been destroyed.
+    void Term();
+
+    bool IsInitialized() const { return m_bInitialized; }
+    bool IsDeferred() const { return m_bDeferred; }
+    bool IsDirectIO() const { return m_bDirectIO; }
+
+    // See TigerDeviceRouter::AddDevice. The scheduler type and I/O memory alignment of
+    // in_deviceSettings are overridden to match the default device.
+    AKRESULT AddDevice(TigerDeviceClass in_eClass, const AkDeviceSettings &in_deviceSettings);
+
+    // The hook, as the resolver of the files of this context.
+    AK::StreamMgr::IAkFileLocationResolver *GetResolver();
+
+    // Opens a standard stream on in_fileID, resolved by this context. in_bStreamed selects the
+    // flags of streamed media (read window by window) over those of a bank (read whole into the
+    // file cache). The open is synchronous.
+    AKRESULT OpenStd(AkFileID in_fileID, bool in_bStreamed, AK::IAkStdStream *&out_pStream);
+
+    void SetWriteBehind(TigerWriteBehindIo *in_pWriteBehind);
+    bool IsUringActive() const { return m_bDeferred && m_deferred.IsUringActive(); }
+
+    TigerFileCache &GetFileCache() { return m_bDeferred ? m_deferred.GetFileCache() : m_blocking.GetFileCache(); }
+    TigerFaultInjector &GetFaultInjector() { return m_bDeferred ? m_deferred.GetFaultInjector() : m_blocking.GetFaultInjector(); }
+    TigerReadRecorder &GetReadRecorder() { return m_bDeferred ? m_deferred.GetReadRecorder() : m_blocking.GetReadRecorder(); }
+    void GetIoStats(TigerDeviceClass in_eClass, TigerIoDeviceStats &out_stats);
+    void ResetIoStats();
+
+    // The context in_pFlags were built for by OpenStd, NULL if they weren't (e.g. opens of the
+    // sound engine) or the context was terminated since.
+    static TigerStreamContext *FromFlags(const AkFileSystemFlags *in_pFlags);
+
+private:
+    TigerPackageIo m_blocking;
+    TigerPackageIoDeferred m_deferred;
+    bool m_bDeferred;
+    bool m_bDirectIO;
+    bool m_bInitialized;
+
+    // Contexts that are initialized, so FromFlags never follows a dangling pointer.
+    static std::mutex s_contextsLock;
+    static std::unordered_set<TigerStreamContext *> s_contexts;
+};
+
+// File Location Resolver of the Stream Manager while Tiger contexts exist. Opens issued through
+// TigerStreamContext::OpenStd go to their context, everything else to the default resolver (the
+// default context's hook, or a TigerLayeredResolver chaining it).
+class TigerContextResolver : public AK::StreamMgr::IAkFileLocationResolver
+{
+public:
+    TigerContextResolver() : m_pDefault(NULL) {}
+
+    void SetDefault(AK::StreamMgr::IAkFileLocationResolver *in_pDefault) { m_pDefault = in_pDefault; }
+    AK::StreamMgr::IAkFileLocationResolver *GetDefault() const { return m_pDefault; }
+
+    // Registers this object with the Stream Manager, unless another resolver already is.
+    void Install();
+    void Uninstall();
+
+    virtual AKRESULT Open(
+        const AkOSChar *in_pszFileName, // File name.
+        AkOpenMode in_eOpenMode,        // Open mode.
+        AkFileSystemFlags *in_pFlags,   // Special flags. Can pass NULL.
+        bool &io_bSyncOpen,             // If true, the file must be opened synchronously. Otherwise it is left at the File Location Resolver's discretion. Return false if Open needs to be deferred.
+        AkFileDesc &out_fileDesc        // Returned file descriptor.
+    );
+
+    virtual AKRESULT Open(
+        AkFileID in_fileID,           // File ID.
+        AkOpenMode in_eOpenMode,      // Open mode.
+        AkFileSystemFlags *in_pFlags, // Special flags. Can pass NULL.
+        bool &io_bSyncOpen,           // If true, the file must be opened synchronously. Otherwise it is left at the File Location Resolver's discretion. Return false if Open needs to be deferred.
+        AkFileDesc &out_fileDesc      // Returned file descriptor.
+    );
+
+private:
+    AK::StreamMgr::IAkFileLocationResolver *Resolve(const AkFileSystemFlags *in_pFlags);
+
+    AK::StreamMgr::IAkFileLocationResolver *m_pDefault;
+};
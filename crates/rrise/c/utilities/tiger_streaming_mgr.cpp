@@ -2,20 +2,312 @@
  * Copyright (c) 2022 Contributors to the Rrise project
  */
 
+#include "default_streaming_mgr.h"
 #include "tiger_io_hook.h"
+#include "tiger_io_hook_deferred.h"
+#include "tiger_layered_resolver.h"
+#include "tiger_stream_context.h"
 #include "tiger_streaming_mgr.h"
 #include <AkFilePackageLowLevelIOBlocking.h>
 
-static TigerPackageIo g_lowLevelIO;
+// The context of the sound engine, served from the process-wide file provider. Other contexts
+// are created through CreateTigerStreamContext.
+static TigerStreamContext g_defaultContext;
+static TigerContextResolver g_contextResolver;
+static TigerLayeredResolver g_layeredResolver;
+static TigerWriteBehindIo g_writeBehind;
 
-AKRESULT InitTigerStreamMgr(const AkDeviceSettings& deviceSettings)
+AKRESULT InitTigerStreamMgr(const AkDeviceSettings& deviceSettings, bool directIO)
 {
     // AKRESULT r = g_lowLevelIO.Init(deviceSettings);
     // if (r == AK_Success) {
     //     g_lowLevelIO.SetBasePath(basePath);
     // }
 
-	return g_lowLevelIO.Init(deviceSettings);
+	// Installed first, so the hook doesn't register itself as the File Location Resolver.
+	g_contextResolver.SetDefault(NULL);
+	g_contextResolver.Install();
+	AKRESULT eResult = g_defaultContext.Init(deviceSettings, 0, 0, directIO, NULL);
+	if (eResult == AK_Success)
+		g_contextResolver.SetDefault(g_defaultContext.GetResolver());
+	return eResult;
+}
+
+AKRESULT InitTigerStreamMgrDeferred(const AkDeviceSettings& deviceSettings, AkUInt32 numWorkerThreads, AkUInt32 uringQueueDepth, bool directIO)
+{
+	if (numWorkerThreads == 0)
+		return AK_InvalidParameter;
+
+	g_contextResolver.SetDefault(NULL);
+	g_contextResolver.Install();
+	AKRESULT eResult = g_defaultContext.Init(deviceSettings, numWorkerThreads, uringQueueDepth, directIO, NULL);
+	if (eResult == AK_Success)
+		g_contextResolver.SetDefault(g_defaultContext.GetResolver());
+	return eResult;
+}
+
+AKRESULT AddTigerStreamDevice(TigerDeviceClass deviceClass, const AkDeviceSettings& deviceSettings)
+{
+	return g_defaultContext.AddDevice(deviceClass, deviceSettings);
+}
+
+bool IsTigerIoUringActive()
+{
+	return g_defaultContext.IsUringActive();
+}
+
+AKRESULT InitTigerLayeredResolver(const AkDeviceSettings& defaultDeviceSettings)
+{
+	if (g_layeredResolver.HasLayers())
+		return AK_Fail;
+
+	AKRESULT eResult = InitDefaultStreamMgr(defaultDeviceSettings);
+	if (eResult != AK_Success)
+		return eResult;
+
+	g_layeredResolver.AddLayer(g_defaultContext.GetResolver());
+	g_layeredResolver.AddLayer(GetDefaultStreamMgrResolver());
+	g_contextResolver.SetDefault(&g_layeredResolver);
+	return AK_Success;
+}
+
+void ClearTigerNegativeLookupCache()
+{
+	g_layeredResolver.ClearNegativeCache();
+}
+
+AkUInt64 GetTigerNegativeLookupHits()
+{
+	return g_layeredResolver.GetNegativeHits();
+}
+
+AKRESULT InitTigerWriteBehind(const AkDeviceSettings& deviceSettings, size_t maxPendingBytes)
+{
+	AKRESULT eResult = g_writeBehind.Init(deviceSettings, maxPendingBytes);
+	if (eResult != AK_Success)
+		return eResult;
+
+	g_defaultContext.SetWriteBehind(&g_writeBehind);
+	return AK_Success;
+}
+
+void FlushTigerWriteBehind()
+{
+	if (g_writeBehind.IsInitialized())
+		g_writeBehind.Flush();
+}
+
+void GetTigerWriteBehindStats(TigerWriteBehindStats* outStats)
+{
+	g_writeBehind.GetStats(*outStats);
+}
+
+AKRESULT PinTigerStreamedFile(AkFileID fileID, AkPriority priority)
+{
+	if (!AK::IAkStreamMgr::Get())
+		return AK_Fail;
+
+	// Open the file the way the sound engine opens streamed media, so it resolves to the same
+	// (streamed) package file and cache entry.
+	AkFileSystemFlags flags(AKCOMPANYID_AUDIOKINETIC, AKCODECID_VORBIS, 0, NULL, false, true, fileID);
+	return AK::IAkStreamMgr::Get()->PinFileInCache(fileID, &flags, priority);
+}
+
+AKRESULT UnpinTigerStreamedFile(AkFileID fileID, AkPriority priority)
+{
+	if (!AK::IAkStreamMgr::Get())
+		return AK_Fail;
+	return AK::IAkStreamMgr::Get()->UnpinFileInCache(fileID, priority);
+}
+
+AKRESULT UpdateTigerStreamedFilePriority(AkFileID fileID, AkPriority priority, AkPriority oldPriority)
+{
+	if (!AK::IAkStreamMgr::Get())
+		return AK_Fail;
+	return AK::IAkStreamMgr::Get()->UpdateCachingPriority(fileID, priority, oldPriority);
+}
+
+AKRESULT GetTigerPinnedFileStatus(AkFileID fileID, AkReal32* outPercentBuffered, bool* outCacheFull)
+{
+	if (!AK::IAkStreamMgr::Get())
+		return AK_Fail;
+	return AK::IAkStreamMgr::Get()->GetBufferStatusForPinnedFile(fileID, *outPercentBuffered, *outCacheFull);
+}
+
+AKRESULT OpenTigerStdStream(AkFileID fileID, bool streamed, void** outStream)
+{
+	return OpenTigerContextStdStream(&g_defaultContext, fileID, streamed, outStream);
+}
+
+AKRESULT CreateTigerStreamContext(const AkDeviceSettings& deviceSettings, AkUInt32 numWorkerThreads, AkUInt32 uringQueueDepth, bool directIO, const void* fileSource, void** outContext)
+{
+	*outContext = NULL;
+	if (!AK::IAkStreamMgr::Get())
+		return AK_Fail;
+
+	TigerStreamContext* pContext = new TigerStreamContext();
+	g_contextResolver.Install();
+	AKRESULT eResult = pContext->Init(deviceSettings, numWorkerThreads, uringQueueDepth, directIO, fileSource);
+	if (eResult != AK_Success)
+	{
+		delete pContext;
+		return eResult;
+	}
+
+	*outContext = pContext;
+	return AK_Success;
+}
+
+void DestroyTigerStreamContext(void* context)
+{
+	TigerStreamContext* pContext = (TigerStreamContext*)context;
+	pContext->Term();
+	delete pContext;
+}
+
+AKRESULT AddTigerContextStreamDevice(void* context, TigerDeviceClass deviceClass, const AkDeviceSettings& deviceSettings)
+{
+	return ((TigerStreamContext*)context)->AddDevice(deviceClass, deviceSettings);
+}
+
+AKRESULT OpenTigerContextStdStream(void* context, AkFileID fileID, bool streamed, void** outStream)
+{
+	AK::IAkStdStream* pStream = NULL;
+	AKRESULT eResult = ((TigerStreamContext*)context)->OpenStd(fileID, streamed, pStream);
+	*outStream = pStream;
+	return eResult;
+}
+
+void SetTigerContextFileCacheBudget(void* context, size_t budgetBytes)
+{
+	((TigerStreamContext*)context)->GetFileCache().SetBudget(budgetBytes);
+}
+
+void GetTigerContextFileCacheStats(void* context, TigerFileCacheStats* outStats)
+{
+	((TigerStreamContext*)context)->GetFileCache().GetStats(*outStats);
+}
+
+void GetTigerContextIoStats(void* context, TigerDeviceClass deviceClass, TigerIoDeviceStats* outStats)
+{
+	((TigerStreamContext*)context)->GetIoStats(deviceClass, *outStats);
+}
+
+void SetTigerContextFaultProfile(void* context, TigerDeviceClass deviceClass, const TigerFaultProfile* profile)
+{
+	((TigerStreamContext*)context)->GetFaultInjector().SetProfile(deviceClass, profile);
+}
+
+AKRESULT ReadTigerStdStream(void* stream, void* buffer, AkUInt32 size, AkUInt32* outSize)
+{
+	AK::IAkStdStream* pStream = (AK::IAkStdStream*)stream;
+	AKRESULT eResult = pStream->Read(buffer, size, true, AK_DEFAULT_PRIORITY, 0.f, *outSize);
+	if (eResult == AK_Success && pStream->GetStatus() == AK_StmStatusError)
+		return AK_Fail;
+	return eResult;
+}
+
+void CloseTigerStdStream(void* stream)
+{
+	((AK::IAkStdStream*)stream)->Destroy();
+}
+
+static TigerFileCache& GetActiveFileCache()
+{
+	return g_defaultContext.GetFileCache();
+}
+
+void SetTigerFileCacheBudget(size_t budgetBytes)
+{
+	GetActiveFileCache().SetBudget(budgetBytes);
+}
+
+void GetTigerFileCacheStats(TigerFileCacheStats* outStats)
+{
+	GetActiveFileCache().GetStats(*outStats);
+}
+
+void PrefetchTigerFiles(const AkFileID* fileIDs, AkUInt32 count, bool urgent)
+{
+	TigerFileCache& cache = GetActiveFileCache();
+	// Urgent files are pushed to the front one by one, go backwards to keep them in order.
+	for (AkUInt32 i = 0; i < count; i++)
+		cache.Prefetch(fileIDs[urgent ? count - 1 - i : i], urgent);
+}
+
+void SetTigerFilePrefetchThreads(AkUInt32 count)
+{
+	GetActiveFileCache().SetPrefetchThreads(count);
+}
+
+void StartTigerReadRecording(AkUInt32 durationMs)
+{
+	g_defaultContext.GetReadRecorder().Start(durationMs);
+}
+
+void StopTigerReadRecording()
+{
+	g_defaultContext.GetReadRecorder().Stop();
+}
+
+AkUInt32 GetTigerRecordedReads(TigerRecordedRead* outReads, AkUInt32 maxReads)
+{
+	return g_defaultContext.GetReadRecorder().GetReads(outReads, maxReads);
+}
+
+void SetTigerBufferPoolMaxRetained(size_t maxRetainedBytes)
+{
+	GetActiveFileCache().GetBufferPool().SetMaxRetained(maxRetainedBytes);
+}
+
+void GetTigerBufferPoolStats(TigerBufferPoolStats* outStats)
+{
+	GetActiveFileCache().GetBufferPool().GetStats(*outStats);
+}
+
+static TigerFaultInjector& GetActiveFaultInjector()
+{
+	return g_defaultContext.GetFaultInjector();
+}
+
+void SetTigerFaultProfile(TigerDeviceClass deviceClass, const TigerFaultProfile* profile)
+{
+	GetActiveFaultInjector().SetProfile(deviceClass, profile);
+}
+
+void SetTigerFaultSeed(AkUInt64 seed)
+{
+	GetActiveFaultInjector().SetSeed(seed);
+}
+
+void GetTigerFaultStats(TigerFaultStats* outStats)
+{
+	GetActiveFaultInjector().GetStats(*outStats);
+}
+
+void ResetTigerFaultStats()
+{
+	GetActiveFaultInjector().ResetStats();
+}
+
+bool RecordTigerMonitorError(AK::Monitor::ErrorCode errorCode)
+{
+	return GetActiveFaultInjector().RecordMonitorError(errorCode);
+}
+
+void GetTigerIoStats(TigerDeviceClass deviceClass, TigerIoDeviceStats* outStats)
+{
+	g_defaultContext.GetIoStats(deviceClass, *outStats);
+}
+
+void ResetTigerIoStats()
+{
+	g_defaultContext.ResetIoStats();
+}
+
+void SetTigerIoTraceLevel(AkUInt32 level)
+{
+	g_tigerIoTraceLevel.store(level, std::memory_order_relaxed);
 }
 
 // AKRESULT SetBasePath(const AkOSChar* in_pszBasePath)
@@ -30,7 +322,21 @@ AKRESULT InitTigerStreamMgr(const AkDeviceSettings& deviceSettings)
 
 void TermTigerStreamMgr()
 {
-	g_lowLevelIO.Term();
+	if (g_layeredResolver.HasLayers())
+	{
+		g_contextResolver.SetDefault(NULL);
+		g_layeredResolver.RemoveAllLayers();
+		TermDefaultStreamMgrDevice();
+	}
+
+	// Flushes and closes the captures still being written.
+	g_writeBehind.Term();
+	g_defaultContext.SetWriteBehind(NULL);
+
+	g_contextResolver.SetDefault(NULL);
+	if (g_defaultContext.IsInitialized())
+		g_defaultContext.Term();
+	g_contextResolver.Uninstall();
 	if (AK::IAkStreamMgr::Get())
 	{
 		AK::IAkStreamMgr::Get()->Destroy();
@@ -6,8 +6,91 @@
 #define TIGER_STREAMING_MGR_H
 
 #include <AK/SoundEngine/Common/AkStreamMgrModule.h>
+#include "tiger_device_router.h"
+#include "tiger_fault_injector.h"
+#include "tiger_file_cache.h"
+#include "tiger_io_stats.h"
+#include "tiger_read_recorder.h"
+#include "tiger_write_behind.h"
 
-AKRESULT InitTigerStreamMgr(const AkDeviceSettings& deviceSettings);
+AKRESULT InitTigerStreamMgr(const AkDeviceSettings& deviceSettings, bool directIO);
+AKRESULT InitTigerStreamMgrDeferred(const AkDeviceSettings& deviceSettings, AkUInt32 numWorkerThreads, AkUInt32 uringQueueDepth, bool directIO);
+bool IsTigerIoUringActive();
+// Gives a class of files a device of its own, after InitTigerStreamMgr*. The scheduler type and
+// I/O memory alignment of deviceSettings are overridden to match the default device.
+AKRESULT AddTigerStreamDevice(TigerDeviceClass deviceClass, const AkDeviceSettings& deviceSettings);
 void TermTigerStreamMgr();
 
+// Chains the default file-package device (and its base paths) behind the Tiger device, so files
+// missing from the packages are looked up on disk. Must be called after InitTigerStreamMgr*.
+AKRESULT InitTigerLayeredResolver(const AkDeviceSettings& defaultDeviceSettings);
+void ClearTigerNegativeLookupCache();
+AkUInt64 GetTigerNegativeLookupHits();
+
+// Stream cache pinning of streamed media, see AK::IAkStreamMgr::PinFileInCache. Fail with
+// AK_Fail when no Stream Manager exists.
+AKRESULT PinTigerStreamedFile(AkFileID fileID, AkPriority priority);
+AKRESULT UnpinTigerStreamedFile(AkFileID fileID, AkPriority priority);
+AKRESULT UpdateTigerStreamedFilePriority(AkFileID fileID, AkPriority priority, AkPriority oldPriority);
+AKRESULT GetTigerPinnedFileStatus(AkFileID fileID, AkReal32* outPercentBuffered, bool* outCacheFull);
+
+// Opens the files written by the engine (output and profiler captures) on a write-behind device,
+// after InitTigerStreamMgr*. See TigerWriteBehindIo.
+AKRESULT InitTigerWriteBehind(const AkDeviceSettings& deviceSettings, size_t maxPendingBytes);
+void FlushTigerWriteBehind();
+void GetTigerWriteBehindStats(TigerWriteBehindStats* outStats);
+
+// Standard streams reading a Wwise file through the whole Stream Manager stack, for tools and
+// benchmarks. streamed selects the flags of streamed media (read window by window) over those of
+// a bank (read whole into the file cache). Reads are blocking.
+AKRESULT OpenTigerStdStream(AkFileID fileID, bool streamed, void** outStream);
+AKRESULT ReadTigerStdStream(void* stream, void* buffer, AkUInt32 size, AkUInt32* outSize);
+void CloseTigerStdStream(void* stream);
+
+// Fault injection into the transfers of a class of files, see TigerFaultInjector. A NULL profile
+// stops injecting into that class.
+void SetTigerFaultProfile(TigerDeviceClass deviceClass, const TigerFaultProfile* profile);
+void SetTigerFaultSeed(AkUInt64 seed);
+void GetTigerFaultStats(TigerFaultStats* outStats);
+void ResetTigerFaultStats();
+// Feeds an error of the engine's monitoring callback to the starvation counters of
+// TigerFaultStats. Returns whether it reported starvation.
+bool RecordTigerMonitorError(AK::Monitor::ErrorCode errorCode);
+
+// Independent Tiger I/O configurations, see TigerStreamContext. Must be created once the Stream
+// Manager exists, and destroyed (with all their streams) before it is. numWorkerThreads is 0 for
+// a blocking hook. fileSource is handed back to the ddumbe_* callbacks for every file the context
+// reads, NULL selects the process-wide file provider. The functions above act on the default
+// context, the one InitTigerStreamMgr* initializes for the sound engine.
+AKRESULT CreateTigerStreamContext(const AkDeviceSettings& deviceSettings, AkUInt32 numWorkerThreads, AkUInt32 uringQueueDepth, bool directIO, const void* fileSource, void** outContext);
+void DestroyTigerStreamContext(void* context);
+AKRESULT AddTigerContextStreamDevice(void* context, TigerDeviceClass deviceClass, const AkDeviceSettings& deviceSettings);
+AKRESULT OpenTigerContextStdStream(void* context, AkFileID fileID, bool streamed, void** outStream);
+void SetTigerContextFileCacheBudget(void* context, size_t budgetBytes);
+void GetTigerContextFileCacheStats(void* context, TigerFileCacheStats* outStats);
+void GetTigerContextIoStats(void* context, TigerDeviceClass deviceClass, TigerIoDeviceStats* outStats);
+void SetTigerContextFaultProfile(void* context, TigerDeviceClass deviceClass, const TigerFaultProfile* profile);
+
+void SetTigerFileCacheBudget(size_t budgetBytes);
+void GetTigerFileCacheStats(TigerFileCacheStats* outStats);
+
+// Queues files to be read whole into the file cache on its background threads, see
+// TigerFileCache::Prefetch. Streamed media that is resident when opened is read from the cache.
+void PrefetchTigerFiles(const AkFileID* fileIDs, AkUInt32 count, bool urgent);
+void SetTigerFilePrefetchThreads(AkUInt32 count);
+
+// Records the package file reads of the next durationMs, see TigerReadRecorder. GetTigerRecordedReads
+// copies up to maxReads of them and returns how many were recorded.
+void StartTigerReadRecording(AkUInt32 durationMs);
+void StopTigerReadRecording();
+AkUInt32 GetTigerRecordedReads(TigerRecordedRead* outReads, AkUInt32 maxReads);
+
+void SetTigerBufferPoolMaxRetained(size_t maxRetainedBytes);
+void GetTigerBufferPoolStats(TigerBufferPoolStats* outStats);
+
+// Counters of the device serving deviceClass, see TigerPackageIo::GetIoStats.
+void GetTigerIoStats(TigerDeviceClass deviceClass, TigerIoDeviceStats* outStats);
+void ResetTigerIoStats();
+void SetTigerIoTraceLevel(AkUInt32 level);
+
 #endif // DEFAULT_STREAMING_MGR_H
@@ -0,0 +1,342 @@
+#include <AkFileHelpers.h>
+#include <string.h>
+#include "tiger_io_stats.h"
+#include "tiger_write_behind.h"
+
+#if !defined(AK_WIN)
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#define FILE_HANDLE_TO_FD(h) ((int)(intptr_t)(h))
+#define FD_TO_FILE_HANDLE(fd) ((AkFileHandle)(intptr_t)(fd))
+#endif
+
+AKRESULT TigerWriteBehindIo::Init(const AkDeviceSettings &in_deviceSettings, size_t in_uMaxPendingBytes)
+{
+    if (IsInitialized())
+        return AK_Fail;
+
+    // Write only copies the data, there is nothing to gain from deferring it.
+    AkDeviceSettings settings = in_deviceSettings;
+    settings.uSchedulerTypeFlags = AK_SCHEDULER_BLOCKING;
+
+    m_deviceID = AK::StreamMgr::CreateDevice(settings, this);
+    if (m_deviceID == AK_INVALID_DEVICE_ID)
+        return AK_Fail;
+
+    // Write gathers into one chunk while the previous one is being flushed.
+    m_uMaxPendingBytes = AkMax(in_uMaxPendingBytes, (size_t)2 * TIGER_WRITE_BEHIND_CHUNK_SIZE);
+    m_stats = TigerWriteBehindStats();
+    m_bStopFlushing = false;
+    m_flushThread = std::thread(&TigerWriteBehindIo::FlushMain, this);
+    return AK_Success;
+}
+
+void TigerWriteBehindIo::Term()
+{
+    if (!IsInitialized())
+        return;
+
+    // The Stream Manager closes the streams still open on the device when destroying it.
+    AK::StreamMgr::DestroyDevice(m_deviceID);
+    m_deviceID = AK_INVALID_DEVICE_ID;
+
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        for (auto &file : m_files)
+        {
+            if (!file.second.bClosing)
+                QueueClose(file.first, file.second);
+        }
+        m_bStopFlushing = true;
+    }
+    m_queueSignal.notify_all();
+    m_flushThread.join();
+
+    m_files.clear();
+    m_pool.Trim();
+}
+
+AKRESULT TigerWriteBehindIo::Open(const AkOSChar *in_pszFileName, AkOpenMode in_eOpenMode, AkFileDesc &out_fileDesc)
+{
+    if (in_eOpenMode != AK_OpenModeWrite && in_eOpenMode != AK_OpenModeWriteOvrwr)
+        return AK_InvalidParameter;
+
+    AkFileHandle hFile;
+#if defined(AK_WIN)
+    AKRESULT eResult = CAkFileHelpers::OpenFile(in_pszFileName, in_eOpenMode, false, false, hFile);
+    if (eResult != AK_Success)
+        return eResult;
+#else
+    int fd = ::open(in_pszFileName, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+        return errno == ENOENT ? AK_FileNotFound : AK_Fail;
+    hFile = FD_TO_FILE_HANDLE(fd);
+#endif
+
+    AkUInt64 fileID;
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        fileID = m_uNextFileID++;
+        PendingFile &file = m_files[fileID];
+        file.hFile = hFile;
+        file.pChunk = NULL;
+        file.uChunkPosition = 0;
+        file.uChunkSize = 0;
+        file.bClosing = false;
+        file.bFailed = false;
+    }
+
+    out_fileDesc.iFileSize = 0;
+    out_fileDesc.uSector = 0;
+    out_fileDesc.deviceID = m_deviceID;
+    out_fileDesc.hFile = (AkFileHandle)(uintptr_t)fileID;
+    out_fileDesc.pCustomParam = NULL;
+    out_fileDesc.uCustomParamSize = 0;
+    return AK_Success;
+}
+
+void TigerWriteBehindIo::Flush()
+{
+    std::unique_lock<std::mutex> lock(m_lock);
+    QueuePartialChunks();
+    m_flushedSignal.wait(lock, [this]
+                         { return m_queue.empty() && m_uInFlightChunks == 0; });
+}
+
+void TigerWriteBehindIo::GetStats(TigerWriteBehindStats &out_stats)
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    out_stats = m_stats;
+    out_stats.uPendingBytes = m_uPendingBytes;
+    out_stats.uMaxPendingBytes = m_uMaxPendingBytes;
+}
+
+AKRESULT TigerWriteBehindIo::Read(
+    AkFileDesc &in_fileDesc,             ///< File descriptor.
+    const AkIoHeuristics &in_heuristics, ///< Heuristics for this data transfer.
+    void *out_pBuffer,                   ///< Buffer to be filled with data.
+    AkIOTransferInfo &io_transferInfo    ///< Synchronous data transfer info.
+)
+{
+    // Files are only opened for writing on this device.
+    return AK_Fail;
+}
+
+AKRESULT TigerWriteBehindIo::Write(
+    AkFileDesc &in_fileDesc,             ///< File descriptor.
+    const AkIoHeuristics &in_heuristics, ///< Heuristics for this data transfer.
+    void *in_pData,                      ///< Data to be written.
+    AkIOTransferInfo &io_transferInfo    ///< Synchronous data transfer info.
+)
+{
+    AkUInt64 fileID = (AkUInt64)(uintptr_t)in_fileDesc.hFile;
+    const uint8_t *pSrc = (const uint8_t *)in_pData;
+    AkUInt64 uPosition = io_transferInfo.uFilePosition;
+    AkUInt32 uRemaining = io_transferInfo.uRequestedSize;
+
+    std::unique_lock<std::mutex> lock(m_lock);
+    m_stats.uWrites++;
+    auto it = m_files.find(fileID);
+    if (it == m_files.end() || it->second.bClosing || it->second.bFailed)
+        return AK_Fail;
+    PendingFile &file = it->second;
+
+    while (uRemaining > 0)
+    {
+        // Only contiguous writes are gathered, a seek starts a new chunk.
+        if (file.pChunk && (uPosition != file.uChunkPosition + file.uChunkSize || file.uChunkSize == TIGER_WRITE_BEHIND_CHUNK_SIZE))
+            QueueChunk(fileID, file);
+
+        if (!file.pChunk)
+        {
+            if (m_uPendingBytes + TIGER_WRITE_BEHIND_CHUNK_SIZE > m_uMaxPendingBytes)
+            {
+                // Other files may hold the memory in chunks they are still gathering, which the
+                // flush thread would never free.
+                m_stats.uStalls++;
+                QueuePartialChunks();
+                m_flushedSignal.wait(lock, [this]
+                                     { return m_uPendingBytes + TIGER_WRITE_BEHIND_CHUNK_SIZE <= m_uMaxPendingBytes; });
+            }
+
+            file.pChunk = (uint8_t *)m_pool.Allocate(TIGER_WRITE_BEHIND_CHUNK_SIZE);
+            if (!file.pChunk)
+                return AK_InsufficientMemory;
+            file.uChunkPosition = uPosition;
+            file.uChunkSize = 0;
+            m_uPendingBytes += TIGER_WRITE_BEHIND_CHUNK_SIZE;
+            m_stats.uHighWaterBytes = AkMax(m_stats.uHighWaterBytes, (AkUInt64)m_uPendingBytes);
+        }
+
+        AkUInt32 uCopy = AkMin(uRemaining, (AkUInt32)TIGER_WRITE_BEHIND_CHUNK_SIZE - file.uChunkSize);
+        memcpy(file.pChunk + file.uChunkSize, pSrc, uCopy);
+        file.uChunkSize += uCopy;
+        pSrc += uCopy;
+        uPosition += uCopy;
+        uRemaining -= uCopy;
+    }
+    return AK_Success;
+}
+
+AKRESULT TigerWriteBehindIo::Close(
+    AkFileDesc &in_fileDesc ///< File descriptor.
+)
+{
+    AkUInt64 fileID = (AkUInt64)(uintptr_t)in_fileDesc.hFile;
+
+    std::lock_guard<std::mutex> lock(m_lock);
+    auto it = m_files.find(fileID);
+    if (it == m_files.end() || it->second.bClosing)
+        return AK_Fail;
+
+    // Failures of the writes still queued can't be reported any more, only traced.
+    bool bFailed = it->second.bFailed;
+    QueueClose(fileID, it->second);
+    return bFailed ? AK_Fail : AK_Success;
+}
+
+AkUInt32 TigerWriteBehindIo::GetBlockSize(
+    AkFileDesc &in_fileDesc ///< File descriptor.
+)
+{
+    return 1;
+}
+
+void TigerWriteBehindIo::GetDeviceDesc(
+    AkDeviceDesc &out_deviceDesc ///< Device description.
+)
+{
+    static const AkOSChar szDeviceName[] = AKTEXT("TigerWriteBehindIo");
+
+    out_deviceDesc.bCanRead = false;
+    out_deviceDesc.bCanWrite = true;
+    out_deviceDesc.deviceID = m_deviceID;
+    out_deviceDesc.uStringSize = AKPLATFORM::OsStrLen(szDeviceName);
+    AKPLATFORM::SafeStrCpy(out_deviceDesc.szDeviceName, szDeviceName, AK_MONITOR_DEVICENAME_MAXLENGTH);
+}
+
+AkUInt32 TigerWriteBehindIo::GetDeviceData()
+{
+    return 0;
+}
+
+void TigerWriteBehindIo::QueueChunk(AkUInt64 in_fileID, PendingFile &io_file)
+{
+    m_queue.push_back({in_fileID, io_file.pChunk, io_file.uChunkPosition, io_file.uChunkSize});
+    io_file.pChunk = NULL;
+    io_file.uChunkSize = 0;
+    m_queueSignal.notify_one();
+}
+
+void TigerWriteBehindIo::QueueClose(AkUInt64 in_fileID, PendingFile &io_file)
+{
+    if (io_file.pChunk)
+        QueueChunk(in_fileID, io_file);
+
+    m_queue.push_back({in_fileID, NULL, 0, 0});
+    io_file.bClosing = true;
+    m_queueSignal.notify_one();
+}
+
+void TigerWriteBehindIo::QueuePartialChunks()
+{
+    for (auto &file : m_files)
+    {
+        if (file.second.pChunk && file.second.uChunkSize > 0)
+            QueueChunk(file.first, file.second);
+    }
+}
+
+bool TigerWriteBehindIo::WriteChunk(AkFileHandle in_hFile, const Chunk &in_chunk)
+{
+    const uint8_t *pSrc = in_chunk.pData;
+    AkUInt64 uPosition = in_chunk.uPosition;
+    AkUInt32 uRemaining = in_chunk.uSize;
+    while (uRemaining > 0)
+    {
+#if defined(AK_WIN)
+        OVERLAPPED overlapped = {};
+        overlapped.Offset = (DWORD)(uPosition & 0xFFFFFFFF);
+        overlapped.OffsetHigh = (DWORD)((uPosition >> 32) & 0xFFFFFFFF);
+
+        DWORD uWritten = 0;
+        if (!::WriteFile(in_hFile, pSrc, uRemaining, &uWritten, &overlapped) || uWritten == 0)
+            return false;
+#else
+        ssize_t uWritten = ::pwrite(FILE_HANDLE_TO_FD(in_hFile), pSrc, uRemaining, (off_t)uPosition);
+        if (uWritten < 0 && errno == EINTR)
+            continue;
+        if (uWritten <= 0)
+            return false;
+#endif
+        pSrc += uWritten;
+        uPosition += uWritten;
+        uRemaining -= (AkUInt32)uWritten;
+    }
+    return true;
+}
+
+void TigerWriteBehindIo::CloseFileHandle(AkFileHandle in_hFile)
+{
+#if defined(AK_WIN)
+    CAkFileHelpers::CloseFile(in_hFile);
+#else
+    ::close(FILE_HANDLE_TO_FD(in_hFile));
+#endif
+}
+
+void TigerWriteBehindIo::FlushMain()
+{
+    std::unique_lock<std::mutex> lock(m_lock);
+    for (;;)
+    {
+        m_queueSignal.wait(lock, [this]
+                           { return m_bStopFlushing || !m_queue.empty(); });
+        if (m_queue.empty())
+            return;
+
+        Chunk chunk = m_queue.front();
+        m_queue.pop_front();
+        m_uInFlightChunks++;
+        // Files are only erased below, once their close chunk is processed.
+        PendingFile &file = m_files[chunk.fileID];
+        AkFileHandle hFile = file.hFile;
+        bool bSkip = file.bFailed;
+        lock.unlock();
+
+        bool bWritten = false;
+        if (chunk.pData)
+        {
+            // Once a write failed, the file has a hole: drop the rest of its data.
+            if (!bSkip)
+                bWritten = WriteChunk(hFile, chunk);
+            m_pool.Free(chunk.pData, TIGER_WRITE_BEHIND_CHUNK_SIZE);
+        }
+        else
+            CloseFileHandle(hFile);
+
+        lock.lock();
+        m_uInFlightChunks--;
+        if (chunk.pData)
+        {
+            m_uPendingBytes -= TIGER_WRITE_BEHIND_CHUNK_SIZE;
+            if (bWritten)
+            {
+                m_stats.uFlushes++;
+                m_stats.uBytesWritten += chunk.uSize;
+            }
+            else if (!bSkip)
+            {
+                m_stats.uWriteFailures++;
+                file.bFailed = true;
+                TIGER_IO_TRACE(TigerIoTraceLevel_Errors, "TigerWriteBehindIo: writing %u bytes at %llu failed\n", chunk.uSize, (unsigned long long)chunk.uPosition);
+            }
+        }
+
+        if (!chunk.pData)
+            m_files.erase(chunk.fileID);
+        m_flushedSignal.notify_all();
+    }
+}
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <AK/SoundEngine/Common/AkStreamMgrModule.h>
+#include "tiger_buffer_pool.h"
+
+// Size of the writes issued to the file system. Contiguous writes of the Stream Manager are
+// gathered until a chunk is full.
+#define TIGER_WRITE_BEHIND_CHUNK_SIZE (1024 * 1024)
+// Default amount of written data that may wait in memory before Write blocks.
+#define TIGER_WRITE_BEHIND_DEFAULT_MAX_PENDING (64 * 1024 * 1024)
+
+// Counters exposed to Rust to size the write-behind buffer for a given workload.
+struct TigerWriteBehindStats
+{
+    AkUInt64 uWrites;          // Write calls of the Stream Manager.
+    AkUInt64 uFlushes;         // Chunks written to the file system.
+    AkUInt64 uBytesWritten;    // Bytes written to the file system.
+    AkUInt64 uWriteFailures;   // Chunks the file system failed to write.
+    AkUInt64 uStalls;          // Write calls that waited for the flush thread to free memory.
+    AkUInt64 uPendingBytes;    // Bytes waiting in memory.
+    AkUInt64 uHighWaterBytes;  // Highest uPendingBytes seen so far.
+    AkUInt64 uMaxPendingBytes;
+};
+
+// Writable blocking device for files the engine writes (output capture, profiler capture).
+//
+// Write only copies the data into memory and returns, so the Stream Manager's I/O thread (and the
+// audio thread waiting on it) never waits on the disk. A background thread flushes the data in
+// large sequential writes of TIGER_WRITE_BEHIND_CHUNK_SIZE. Close is asynchronous as well: the
+// file is closed by the flush thread once its data is written.
+//
+// When more than the pending budget is waiting to be flushed, Write blocks until the flush thread
+// catches up, so a disk slower than the capture cannot use up all memory.
+//
+// This is not a File Location Resolver: TigerPackageIo hands the files it opens for writing over
+// to it, see TigerPackageIo::SetWriteBehind.
+class TigerWriteBehindIo : public AK::StreamMgr::IAkIOHookBlocking
+{
+public:
+    TigerWriteBehindIo() : m_deviceID(AK_INVALID_DEVICE_ID), m_uNextFileID(1), m_bStopFlushing(false), m_uMaxPendingBytes(TIGER_WRITE_BEHIND_DEFAULT_MAX_PENDING), m_uPendingBytes(0), m_uInFlightChunks(0), m_stats() {}
+
+    AKRESULT Init(const AkDeviceSettings &in_deviceSettings, size_t in_uMaxPendingBytes);
+
+    // Flushes everything, closes the files still open and destroys the device.
+    void Term();
+
+    bool IsInitialized() const { return m_deviceID != AK_INVALID_DEVICE_ID; }
+
+    // Opens in_pszFileName for writing (AK_OpenModeWrite or AK_OpenModeWriteOvrwr) on this
+    // device.
+    AKRESULT Open(const AkOSChar *in_pszFileName, AkOpenMode in_eOpenMode, AkFileDesc &out_fileDesc);
+
+    // Writes out every partially filled chunk, and waits until all data is on the file system.
+    void Flush();
+
+    void GetStats(TigerWriteBehindStats &out_stats);
+
+    virtual AKRESULT Read(
+        AkFileDesc &in_fileDesc,             ///< File descriptor.
+        const AkIoHeuristics &in_heuristics, ///< Heuristics for this data transfer.
+        void *out_pBuffer,                   ///< Buffer to be filled with data.
+        AkIOTransferInfo &in_transferInfo    ///< Synchronous data transfer info.
+    );
+
+    virtual AKRESULT Write(
+        AkFileDesc &in_fileDesc,             ///< File descriptor.
+        const AkIoHeuristics &in_heuristics, ///< Heuristics for this data transfer.
+        void *in_pData,                      ///< Data to be written.
+        AkIOTransferInfo &io_transferInfo    ///< Synchronous data transfer info.
+    );
+
+    virtual AKRESULT Close(
+        AkFileDesc &in_fileDesc ///< File descriptor.
+    );
+
+    virtual AkUInt32 GetBlockSize(
+        AkFileDesc &in_fileDesc ///< File descriptor.
+    );
+
+    virtual void GetDeviceDesc(
+        AkDeviceDesc &out_deviceDesc ///< Device description.
+    );
+
+    virtual AkUInt32 GetDeviceData();
+
+private:
+    struct PendingFile
+    {
+        AkFileHandle hFile;
+        // Chunk being gathered, not queued yet. Null if there is none.
+        uint8_t *pChunk;
+        AkUInt64 uChunkPosition;
+        AkUInt32 uChunkSize;
+        // Close was called, the file is closed once its queued chunks are written.
+        bool bClosing;
+        // Set by the flush thread when a write failed, reported by the following Write or Close.
+        bool bFailed;
+    };
+
+    // A chunk waiting to be written. A chunk with no data closes its file.
+    struct Chunk
+    {
+        AkUInt64 fileID;
+        uint8_t *pData;
+        AkUInt64 uPosition;
+        AkUInt32 uSize;
+    };
+
+    // m_lock must be held.
+    void QueueChunk(AkUInt64 in_fileID, PendingFile &io_file);
+    void QueueClose(AkUInt64 in_fileID, PendingFile &io_file);
+    void QueuePartialChunks();
+
+    static bool WriteChunk(AkFileHandle in_hFile, const Chunk &in_chunk);
+    static void CloseFileHandle(AkFileHandle in_hFile);
+
+    void FlushMain();
+
+    AkDeviceID m_deviceID;
+
+    std::mutex m_lock;
+    std::condition_variable m_queueSignal;   // Chunks were queued, or the thread must stop.
+    std::condition_variable m_flushedSignal; // Chunks were written.
+    std::unordered_map<AkUInt64, PendingFile> m_files;
+    AkUInt64 m_uNextFileID;
+    std::deque<Chunk> m_queue;
+    std::thread m_flushThread;
+    bool m_bStopFlushing;
+
+    TigerBufferPool m_pool;
+    size_t m_uMaxPendingBytes;
+    size_t m_uPendingBytes;
+    AkUInt32 m_uInFlightChunks;
+    TigerWriteBehindStats m_stats;
+};
@@ -0,0 +1,285 @@
+/*
+ * Copyright (c) 2022 Contributors to the Rrise project
+ */
+
+//! Measures the tiger streaming manager against synthetic files, without game data.
+//!
+//! For 1 to `--streams` concurrent readers, every reader opens files of the synthetic set and
+//! reads them whole through a standard stream, checking their contents. Throughput and the
+//! latency distribution of opens and reads are printed for each level of concurrency.
+//!
+//! ```text
+//! cargo run --release --features examples --example stream_bench -- \
+//!     --streams 8 --files 64 --size 4194304 --latency-us 200 --jitter-us 2000 \
+//!     --backing dir --scheduler deferred --streamed
+//! ```
+
+use rrise::file_provider::{
+    self, synthetic_contents, SyntheticBacking, SyntheticFileProvider, SyntheticFiles,
+};
+use rrise::package_manager::PACKAGE_BLOCK_SIZE;
+use rrise::settings::*;
+use rrise::stream_mgr::{self, TigerIoScheduler, TigerStdStream};
+use rrise::*;
+
+use simple_logger::SimpleLogger;
+use std::path::PathBuf;
+use std::sync::atomic::{AtomicUsize, Ordering};
+use std::sync::Arc;
+use std::time::{Duration, Instant};
+
+#[cfg(windows)]
+use cc;
+
+const FIRST_FILE_ID: u32 = 0x1000_0000;
+
+struct Options {
+    streams: usize,
+    files: u32,
+    size: usize,
+    block: usize,
+    latency: Duration,
+    jitter: Duration,
+    backing: SyntheticBacking,
+    scheduler: TigerIoScheduler,
+    streamed: bool,
+}
+
+impl Options {
+    fn parse() -> Self {
+        let mut options = Self {
+            streams: 8,
+            files: 32,
+            size: 4 * 1024 * 1024,
+            block: PACKAGE_BLOCK_SIZE,
+            latency: Duration::ZERO,
+            jitter: Duration::ZERO,
+            backing: SyntheticBacking::Memory,
+            scheduler: TigerIoScheduler::Blocking,
+            streamed: false,
+        };
+
+        let mut args = std::env::args().skip(1);
+        while let Some(arg) = args.next() {
+            if arg == "--streamed" {
+                options.streamed = true;
+                continue;
+            }
+
+            let value = args
+                .next()
+                .unwrap_or_else(|| usage(&format!("missing value for {arg}")));
+            let number = || {
+                value
+                    .parse::<u64>()
+                    .unwrap_or_else(|_| usage(&format!("{arg} expects a number")))
+            };
+            match arg.as_str() {
+                "--streams" => options.streams = number().max(1) as usize,
+                "--files" => options.files = number().max(1) as u32,
+                "--size" => options.size = number() as usize,
+                "--block" => options.block = number().max(1) as usize,
+                "--latency-us" => options.latency = Duration::from_micros(number()),
+                "--jitter-us" => options.jitter = Duration::from_micros(number()),
+                "--backing" => {
+                    options.backing = match value.as_str() {
+                        "memory" => SyntheticBacking::Memory,
+                        "dir" => SyntheticBacking::Directory(std::env::temp_dir()),
+                        path => SyntheticBacking::Directory(PathBuf::from(path)),
+                    }
+                }
+                "--scheduler" => {
+                    options.scheduler = match value.as_str() {
+                        "blocking" => TigerIoScheduler::Blocking,
+                        "deferred" => TigerIoScheduler::Deferred { workers: 4 },
+                        "uring" => TigerIoScheduler::DeferredUring {
+                            workers: 4,
+                            queue_depth: 64,
+                        },
+                        _ => usage("--scheduler is blocking, deferred or uring"),
+                    }
+                }
+                _ => usage(&format!("unknown option {arg}")),
+            }
+        }
+
+        options
+    }
+}
+
+fn usage(error: &str) -> ! {
+    eprintln!("{error}");
+    eprintln!(
+        "usage: stream_bench [--streams N] [--files N] [--size BYTES] [--block BYTES] \
+         [--latency-us US] [--jitter-us US] [--backing memory|dir|<path>] \
+         [--scheduler blocking|deferred|uring] [--streamed]"
+    );
+    std::process::exit(2);
+}
+
+#[derive(Default)]
+struct Samples {
+    opens: Vec<Duration>,
+    reads: Vec<Duration>,
+    bytes: usize,
+}
+
+fn main() -> Result<(), AkResult> {
+    SimpleLogger::new()
+        .with_level(log::LevelFilter::Warn)
+        .init()
+        .unwrap();
+    let options = Options::parse();
+
+    let provider = SyntheticFileProvider::new(SyntheticFiles {
+        backing: options.backing.clone(),
+        read_latency: options.latency,
+        read_jitter: options.jitter,
+        ..SyntheticFiles::uniform(FIRST_FILE_ID, options.files, options.size)
+    })
+    .expect("Couldn't generate the synthetic files");
+    file_provider::set_file_provider(Arc::new(provider));
+
+    memory_mgr::init(&mut AkMemSettings::default())?;
+    stream_mgr::init_tiger_stream_mgr(
+        &AkStreamMgrSettings::default(),
+        &mut AkDeviceSettings::default(),
+        options.scheduler,
+        false,
+    )?;
+
+    println!(
+        "{} files of {} bytes, {} byte reads, {:?} backing, {:?}, {}",
+        options.files,
+        options.size,
+        options.block,
+        options.backing,
+        options.scheduler,
+        if options.streamed {
+            "streamed"
+        } else {
+            "banks"
+        }
+    );
+    println!(
+        "{:>7} {:>10} {:>10} {:>10} {:>10} {:>10} {:>10} {:>10}",
+        "streams", "MB/s", "open p50", "open p99", "read p50", "read p99", "read p99.9", "read max"
+    );
+
+    let mut result = Ok(());
+    for streams in 1..=options.streams {
+        match run(&options, streams) {
+            Ok((samples, elapsed)) => report(streams, samples, elapsed),
+            Err(e) => {
+                result = Err(e);
+                break;
+            }
+        }
+    }
+
+    stream_mgr::term_tiger_stream_mgr();
+    memory_mgr::term();
+    file_provider::reset_file_provider();
+    result
+}
+
+/// Reads every synthetic file once, split between `streams` threads.
+fn run(options: &Options, streams: usize) -> Result<(Samples, Duration), AkResult> {
+    let next_file = AtomicUsize::new(0);
+    let start = Instant::now();
+
+    let results: Vec<Result<Samples, AkResult>> = std::thread::scope(|s| {
+        let readers: Vec<_> = (0..streams)
+            .map(|_| s.spawn(|| read_files(options, &next_file)))
+            .collect();
+        readers.into_iter().map(|r| r.join().unwrap()).collect()
+    });
+    let elapsed = start.elapsed();
+
+    let mut total = Samples::default();
+    for samples in results {
+        let samples = samples?;
+        total.opens.extend(samples.opens);
+        total.reads.extend(samples.reads);
+        total.bytes += samples.bytes;
+    }
+    Ok((total, elapsed))
+}
+
+fn read_files(options: &Options, next_file: &AtomicUsize) -> Result<Samples, AkResult> {
+    let mut samples = Samples::default();
+    let mut buf = vec![0; options.block];
+    let mut expected = vec![0; options.block];
+
+    loop {
+        let index = next_file.fetch_add(1, Ordering::Relaxed);
+        if index >= options.files as usize {
+            return Ok(samples);
+        }
+        let file_id = FIRST_FILE_ID + index as u32;
+
+        let start = Instant::now();
+        let mut stream = TigerStdStream::open(file_id, options.streamed)?;
+        samples.opens.push(start.elapsed());
+
+        let mut offset = 0;
+        loop {
+            let start = Instant::now();
+            let read = stream.read(&mut buf)?;
+            samples.reads.push(start.elapsed());
+            if read == 0 {
+                break;
+            }
+
+            synthetic_contents(file_id, offset as u64, &mut expected[..read]);
+            if buf[..read] != expected[..read] {
+                log::error!("File {file_id} has unexpected contents at {offset}");
+                return Err(AkResult::AK_Fail);
+            }
+            offset += read;
+            if read < buf.len() {
+                break;
+            }
+        }
+
+        if offset != options.size {
+            log::error!(
+                "Read {offset} bytes of file {file_id} instead of {}",
+                options.size
+            );
+            return Err(AkResult::AK_Fail);
+        }
+        samples.bytes += offset;
+    }
+}
+
+fn report(streams: usize, mut samples: Samples, elapsed: Duration) {
+    samples.opens.sort_unstable();
+    samples.reads.sort_unstable();
+
+    let mb_per_sec = samples.bytes as f64 / (1024.0 * 1024.0) / elapsed.as_secs_f64();
+    println!(
+        "{:>7} {:>10.1} {:>10} {:>10} {:>10} {:>10} {:>10} {:>10}",
+        streams,
+        mb_per_sec,
+        format_ms(percentile(&samples.opens, 0.5)),
+        format_ms(percentile(&samples.opens, 0.99)),
+        format_ms(percentile(&samples.reads, 0.5)),
+        format_ms(percentile(&samples.reads, 0.99)),
+        format_ms(percentile(&samples.reads, 0.999)),
+        format_ms(samples.reads.last().copied().unwrap_or_default()),
+    );
+}
+
+/// `sorted` must be sorted.
+fn percentile(sorted: &[Duration], p: f64) -> Duration {
+    if sorted.is_empty() {
+        return Duration::ZERO;
+    }
+    let rank = ((sorted.len() as f64 * p).ceil() as usize).clamp(1, sorted.len());
+    sorted[rank - 1]
+}
+
+fn format_ms(d: Duration) -> String {
+    format!("{:.3}ms", d.as_secs_f64() * 1000.0)
+}
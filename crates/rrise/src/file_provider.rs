@@ -0,0 +1,340 @@
+//! Source of the Wwise files (banks and media) the tiger streaming manager reads.
+//!
+//! The I/O hook fetches files through the `ddumbe_*` symbols, which forward to the provider set
+//! with [set_file_provider]. By default that is [PackageFileProvider], reading from the Destiny
+//! packages of [crate::package_manager]. [SyntheticFileProvider] serves generated files instead,
+//! so the stream layer can be exercised and benchmarked without game data.
+
+use crate::package_manager;
+use crate::AkResult;
+use lazy_static::lazy_static;
+use log::debug;
+use std::collections::HashMap;
+use std::fs::File;
+use std::path::PathBuf;
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::sync::{Arc, RwLock};
+use std::time::Duration;
+
+/// Serves Wwise files by their ID. Called from the streaming manager's I/O threads, possibly
+/// concurrently.
+pub trait WwiseFileProvider: Send + Sync {
+    /// Size of file `id` in bytes, `None` if there is no such file.
+    fn file_size(&self, id: u32) -> Option<usize>;
+
+    /// Fills `out` with the bytes of file `id` starting at `offset`. The range is always within
+    /// the file.
+    fn read_range(&self, id: u32, offset: u64, out: &mut [u8]) -> Result<(), AkResult>;
+
+    /// Size of the blocks file `id` is best read in when streamed: reads are aligned to it and
+    /// made of whole blocks, on devices whose granularity is a multiple of it. 1 reads anywhere.
+    fn block_size(&self, _id: u32) -> usize {
+        1
+    }
+}
+
+lazy_static! {
+    static ref PROVIDER: RwLock<Arc<dyn WwiseFileProvider>> =
+        RwLock::new(Arc::new(PackageFileProvider));
+}
+
+/// Replaces the provider the tiger streaming manager reads files from. Files already open keep
+/// reading from the new provider, so this is best done before any bank is loaded.
+pub fn set_file_provider(provider: Arc<dyn WwiseFileProvider>) {
+    *PROVIDER.write().unwrap() = provider;
+    // Files missing from the previous provider may be in this one.
+    crate::stream_mgr::clear_tiger_negative_lookup_cache();
+}
+
+/// Restores the default [PackageFileProvider].
+pub fn reset_file_provider() {
+    set_file_provider(Arc::new(PackageFileProvider));
+}
+
+pub(crate) fn file_provider() -> Arc<dyn WwiseFileProvider> {
+    PROVIDER.read().unwrap().clone()
+}
+
+/// A provider pinned behind a thin pointer, for the C++ side to hand back to the `ddumbe_*`
+/// callbacks. See [crate::stream_mgr::TigerStreamContext].
+pub(crate) type FileSource = Box<Arc<dyn WwiseFileProvider>>;
+
+/// Calls `f` with the provider `source` points to (the `Arc` held by a [FileSource]), or with the
+/// process-wide provider if it is null.
+///
+/// # Safety
+/// A non-null `source` must point into a live [FileSource].
+pub(crate) unsafe fn with_file_source<R>(
+    source: *const std::ffi::c_void,
+    f: impl FnOnce(&dyn WwiseFileProvider) -> R,
+) -> R {
+    if source.is_null() {
+        f(file_provider().as_ref())
+    } else {
+        f(unsafe { &*(source as *const Arc<dyn WwiseFileProvider>) }.as_ref())
+    }
+}
+
+/// Reads files from the Destiny packages, see [package_manager::initialize_package_manager].
+pub struct PackageFileProvider;
+
+impl WwiseFileProvider for PackageFileProvider {
+    fn file_size(&self, id: u32) -> Option<usize> {
+        package_manager::wwise_file_by_reference(id).map(|(_, file)| file.size)
+    }
+
+    fn block_size(&self, id: u32) -> usize {
+        package_manager::wwise_file_by_reference(id).map_or(1, |(_, file)| package_block_size(file))
+    }
+
+    fn read_range(&self, id: u32, offset: u64, out: &mut [u8]) -> Result<(), AkResult> {
+        let Ok(index) = package_manager::package_index_checked() else {
+            return Err(AkResult::AK_FileNotFound);
+        };
+        let Some(file) = index.file(id) else {
+            return Err(AkResult::AK_FileNotFound);
+        };
+
+        package_manager::read_tag_range(&index, file.tag, offset as usize, out).map_err(|e| {
+            debug!("Ranged read of {} failed: {e}", file.tag);
+            AkResult::AK_Fail
+        })
+    }
+}
+
+/// Reads files from a package set of its own, independently of the one given to
+/// [package_manager::initialize_package_manager]. Meant for [crate::stream_mgr::TigerStreamContext]s.
+pub struct PackageSetFileProvider {
+    index: Arc<package_manager::WwisePackageIndex>,
+}
+
+impl PackageSetFileProvider {
+    pub fn new(index: Arc<package_manager::WwisePackageIndex>) -> Self {
+        Self { index }
+    }
+}
+
+impl WwiseFileProvider for PackageSetFileProvider {
+    fn file_size(&self, id: u32) -> Option<usize> {
+        self.index.file(id).map(|file| file.size)
+    }
+
+    fn block_size(&self, id: u32) -> usize {
+        self.index.file(id).map_or(1, package_block_size)
+    }
+
+    fn read_range(&self, id: u32, offset: u64, out: &mut [u8]) -> Result<(), AkResult> {
+        let Some(file) = self.index.file(id) else {
+            return Err(AkResult::AK_FileNotFound);
+        };
+
+        package_manager::read_tag_range(&self.index, file.tag, offset as usize, out).map_err(|e| {
+            debug!("Ranged read of {} failed: {e}", file.tag);
+            AkResult::AK_Fail
+        })
+    }
+}
+
+/// Package blocks only line up with the reads of a file that starts at the beginning of one.
+/// Any other file would have each of its reads span two blocks.
+fn package_block_size(file: package_manager::WwiseFile) -> usize {
+    if file.block_offset == 0 {
+        package_manager::PACKAGE_BLOCK_SIZE
+    } else {
+        1
+    }
+}
+
+/// Where [SyntheticFileProvider] keeps its files.
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub enum SyntheticBacking {
+    /// Files are generated in memory, reads are plain copies.
+    Memory,
+    /// Files are written to a directory created under this one, and read back from disk. The
+    /// directory is removed when the provider is dropped.
+    Directory(PathBuf),
+}
+
+/// Configuration of a [SyntheticFileProvider].
+#[derive(Debug, Clone)]
+pub struct SyntheticFiles {
+    /// ID and size of every file.
+    pub files: Vec<(u32, usize)>,
+    pub backing: SyntheticBacking,
+    /// Delay added to every [WwiseFileProvider::file_size] lookup, i.e. to every open.
+    pub lookup_latency: Duration,
+    /// Delay added to every read.
+    pub read_latency: Duration,
+    /// Up to this much is randomly added to `read_latency`, to get a tail.
+    pub read_jitter: Duration,
+}
+
+impl SyntheticFiles {
+    /// `count` files of `size` bytes each, with IDs starting at `first_id`, held in memory and
+    /// served without added latency.
+    pub fn uniform(first_id: u32, count: u32, size: usize) -> Self {
+        Self {
+            files: (first_id..first_id + count).map(|id| (id, size)).collect(),
+            backing: SyntheticBacking::Memory,
+            lookup_latency: Duration::ZERO,
+            read_latency: Duration::ZERO,
+            read_jitter: Duration::ZERO,
+        }
+    }
+}
+
+enum SyntheticStore {
+    Memory(HashMap<u32, Vec<u8>>),
+    Directory {
+        path: PathBuf,
+        files: HashMap<u32, File>,
+    },
+}
+
+/// Serves generated files, with configurable sizes and latency, see [SyntheticFiles].
+///
+/// The contents of file `id` are given by [synthetic_contents], so readers can check what they
+/// got.
+pub struct SyntheticFileProvider {
+    sizes: HashMap<u32, usize>,
+    store: SyntheticStore,
+    lookup_latency: Duration,
+    read_latency: Duration,
+    read_jitter: Duration,
+    jitter_state: AtomicU64,
+}
+
+/// Tells apart the directories of the [SyntheticFileProvider]s of a process.
+static NEXT_SYNTHETIC_DIR: AtomicU64 = AtomicU64::new(0);
+
+impl SyntheticFileProvider {
+    pub fn new(config: SyntheticFiles) -> std::io::Result<Self> {
+        let sizes: HashMap<u32, usize> = config.files.iter().copied().collect();
+        let store = match config.backing {
+            SyntheticBacking::Memory => SyntheticStore::Memory(
+                sizes
+                    .iter()
+                    .map(|(&id, &size)| {
+                        let mut data = vec![0; size];
+                        synthetic_contents(id, 0, &mut data);
+                        (id, data)
+                    })
+                    .collect(),
+            ),
+            SyntheticBacking::Directory(parent) => {
+                // One per provider: dropping one must not remove the files of another.
+                let path = parent.join(format!(
+                    "rrise-synthetic-{}-{}",
+                    std::process::id(),
+                    NEXT_SYNTHETIC_DIR.fetch_add(1, Ordering::Relaxed)
+                ));
+                std::fs::create_dir_all(&path)?;
+                let mut files = HashMap::new();
+                for (&id, &size) in &sizes {
+                    let file_path = path.join(format!("{id}.wem"));
+                    let mut data = vec![0; size];
+                    synthetic_contents(id, 0, &mut data);
+                    std::fs::write(&file_path, &data)?;
+                    files.insert(id, File::open(&file_path)?);
+                }
+                SyntheticStore::Directory { path, files }
+            }
+        };
+
+        Ok(Self {
+            sizes,
+            store,
+            lookup_latency: config.lookup_latency,
+            read_latency: config.read_latency,
+            read_jitter: config.read_jitter,
+            jitter_state: AtomicU64::new(0x9E37_79B9_7F4A_7C15),
+        })
+    }
+
+    fn read_delay(&self) -> Duration {
+        if self.read_jitter.is_zero() {
+            return self.read_latency;
+        }
+
+        // xorshift64, good enough to spread the delays without pulling in a RNG.
+        let mut x = self.jitter_state.load(Ordering::Relaxed);
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        self.jitter_state.store(x, Ordering::Relaxed);
+        let jitter_ns = x % (self.read_jitter.as_nanos() as u64 + 1);
+        self.read_latency + Duration::from_nanos(jitter_ns)
+    }
+}
+
+impl WwiseFileProvider for SyntheticFileProvider {
+    fn file_size(&self, id: u32) -> Option<usize> {
+        if !self.lookup_latency.is_zero() {
+            std::thread::sleep(self.lookup_latency);
+        }
+        self.sizes.get(&id).copied()
+    }
+
+    fn read_range(&self, id: u32, offset: u64, out: &mut [u8]) -> Result<(), AkResult> {
+        let delay = self.read_delay();
+        if !delay.is_zero() {
+            std::thread::sleep(delay);
+        }
+
+        let offset = offset as usize;
+        match &self.store {
+            SyntheticStore::Memory(files) => {
+                let data = files.get(&id).ok_or(AkResult::AK_FileNotFound)?;
+                let src = data
+                    .get(offset..offset + out.len())
+                    .ok_or(AkResult::AK_InvalidParameter)?;
+                out.copy_from_slice(src);
+                Ok(())
+            }
+            SyntheticStore::Directory { files, .. } => {
+                let file = files.get(&id).ok_or(AkResult::AK_FileNotFound)?;
+                read_exact_at(file, out, offset as u64).map_err(|e| {
+                    debug!("Synthetic read of {id} failed: {e}");
+                    AkResult::AK_Fail
+                })
+            }
+        }
+    }
+}
+
+impl Drop for SyntheticFileProvider {
+    fn drop(&mut self) {
+        if let SyntheticStore::Directory { path, files } = &mut self.store {
+            files.clear();
+            let _ = std::fs::remove_dir_all(path);
+        }
+    }
+}
+
+/// Contents of the synthetic file `id` at `offset`: a pattern depending on both, so misplaced
+/// or mixed-up reads don't go unnoticed.
+pub fn synthetic_contents(id: u32, offset: u64, out: &mut [u8]) {
+    for (i, b) in out.iter_mut().enumerate() {
+        let pos = offset + i as u64;
+        *b = ((pos >> 2) as u32 ^ id.rotate_left((pos & 3) as u32 * 8)) as u8;
+    }
+}
+
+#[cfg(unix)]
+fn read_exact_at(file: &File, out: &mut [u8], offset: u64) -> std::io::Result<()> {
+    std::os::unix::fs::FileExt::read_exact_at(file, out, offset)
+}
+
+#[cfg(windows)]
+fn read_exact_at(file: &File, mut out: &mut [u8], mut offset: u64) -> std::io::Result<()> {
+    while !out.is_empty() {
+        match std::os::windows::fs::FileExt::seek_read(file, out, offset)? {
+            0 => return Err(std::io::ErrorKind::UnexpectedEof.into()),
+            n => {
+                out = &mut out[n..];
+                offset += n as u64;
+            }
+        }
+    }
+    Ok(())
+}
@@ -1,13 +1,149 @@
-use destiny_pkg::PackageManager;
+use destiny_pkg::{PackageManager, TagHash};
 use lazy_static::lazy_static;
-use std::sync::{Arc, RwLock};
+use std::collections::hash_map::Entry;
+use std::collections::{HashMap, VecDeque};
+use std::hash::Hash;
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::sync::{Arc, Mutex, OnceLock, RwLock};
+
+/// Package entry type of Wwise files (banks and media).
+const WWISE_FILE_TYPE: u8 = 26;
+
+/// A Wwise file (bank or media) stored in the packages.
+#[derive(Debug, Copy, Clone)]
+pub struct WwiseFile {
+    pub tag: TagHash,
+    pub size: usize,
+    /// Offset of the file in its first package block.
+    pub block_offset: usize,
+}
+
+/// Source of [WwisePackageIndex::id].
+static NEXT_INDEX_ID: AtomicU64 = AtomicU64::new(0);
+
+/// A package set, indexed by the reference IDs of its Wwise files.
+pub struct WwisePackageIndex {
+    /// Unique to this index for the lifetime of the process, unlike the address of `pm`, which
+    /// a later package manager may reuse once this one is dropped.
+    id: u64,
+    pm: Arc<PackageManager>,
+    /// Wwise reference ID -> package entry, so the I/O hook callbacks don't have to scan every
+    /// package entry through [PackageManager::get_all_by_reference] on each Open.
+    ///
+    /// Unlike that lookup, which matched entries of any type, only Wwise entries
+    /// ([WWISE_FILE_TYPE]) are indexed. A reference held by several of them resolves to the
+    /// lowest tag, whatever order the packages are enumerated in.
+    wwise_files: HashMap<u32, WwiseFile>,
+}
+
+impl WwisePackageIndex {
+    pub fn new(pm: &Arc<PackageManager>) -> Self {
+        let mut wwise_files: HashMap<u32, WwiseFile> = HashMap::new();
+        for (tag, entry) in pm.get_all_by_type(WWISE_FILE_TYPE, None) {
+            let file = WwiseFile {
+                tag,
+                size: entry.file_size as usize,
+                block_offset: entry.starting_block_offset as usize,
+            };
+            match wwise_files.entry(entry.reference) {
+                Entry::Occupied(mut e) if tag.0 < e.get().tag.0 => {
+                    e.insert(file);
+                }
+                Entry::Occupied(_) => {}
+                Entry::Vacant(e) => {
+                    e.insert(file);
+                }
+            }
+        }
+
+        Self {
+            id: NEXT_INDEX_ID.fetch_add(1, Ordering::Relaxed),
+            pm: pm.clone(),
+            wwise_files,
+        }
+    }
+
+    pub fn id(&self) -> u64 {
+        self.id
+    }
+
+    pub fn package_manager(&self) -> &Arc<PackageManager> {
+        &self.pm
+    }
+
+    /// Looks up a Wwise file by its reference ID.
+    pub fn file(&self, id: u32) -> Option<WwiseFile> {
+        self.wwise_files.get(&id).copied()
+    }
+}
+
+/// Identifies a decompressed block: ([WwisePackageIndex::id], package ID, block index). The
+/// package set is part of the key as several may be open at once.
+type BlockKey = (u64, u16, usize);
+
+/// Identifies a whole entry: ([WwisePackageIndex::id], tag), see [BlockKey].
+type TagKey = (u64, u32);
+
+/// Outcome of a read shared by every caller waiting on it. [anyhow::Error] isn't `Clone`.
+type SharedRead = Result<Arc<Vec<u8>>, Arc<anyhow::Error>>;
+
+/// Deduplicates concurrent computations of the same key: the first caller runs it, the callers
+/// arriving while it runs wait for it and get a clone of its result. Nothing is kept once it
+/// completes, caching is left to the caller.
+struct SingleFlight<K, V> {
+    in_flight: Mutex<HashMap<K, Arc<OnceLock<V>>>>,
+}
+
+impl<K: Eq + Hash + Copy, V: Clone> SingleFlight<K, V> {
+    fn new() -> Self {
+        Self {
+            in_flight: Mutex::new(HashMap::new()),
+        }
+    }
+
+    fn run(&self, key: K, f: impl FnOnce() -> V) -> V {
+        let flight = self
+            .in_flight
+            .lock()
+            .unwrap()
+            .entry(key)
+            .or_default()
+            .clone();
+        // Blocks until whichever caller got there first is done.
+        let value = flight.get_or_init(f).clone();
+
+        let mut in_flight = self.in_flight.lock().unwrap();
+        // Unless a later flight of the same key already replaced this one.
+        if in_flight.get(&key).is_some_and(|f| Arc::ptr_eq(f, &flight)) {
+            in_flight.remove(&key);
+        }
+        value
+    }
+}
 
 lazy_static! {
-    static ref PACKAGE_MANAGER: RwLock<Option<Arc<PackageManager>>> = RwLock::new(None);
+    static ref PACKAGE_MANAGER: RwLock<Option<Arc<WwisePackageIndex>>> = RwLock::new(None);
+    /// Recently decompressed blocks, most recent last.
+    static ref BLOCK_CACHE: Mutex<VecDeque<(BlockKey, Arc<Vec<u8>>)>> =
+        Mutex::new(VecDeque::with_capacity(BLOCK_CACHE_CAPACITY));
+    static ref BLOCK_READS: SingleFlight<BlockKey, SharedRead> = SingleFlight::new();
+    static ref TAG_READS: SingleFlight<TagKey, SharedRead> = SingleFlight::new();
 }
 
 pub fn initialize_package_manager(pm: &Arc<PackageManager>) {
-    *PACKAGE_MANAGER.write().unwrap() = Some(pm.clone());
+    *PACKAGE_MANAGER.write().unwrap() = Some(Arc::new(WwisePackageIndex::new(pm)));
+    BLOCK_CACHE.lock().unwrap().clear();
+    // Files missing from the previous packages may be in these.
+    crate::stream_mgr::clear_tiger_negative_lookup_cache();
+}
+
+/// The index built by [initialize_package_manager].
+pub fn package_index_checked() -> anyhow::Result<Arc<WwisePackageIndex>> {
+    PACKAGE_MANAGER
+        .read()
+        .unwrap()
+        .clone()
+        .ok_or_else(|| anyhow::anyhow!("Package manager is not initialized!"))
 }
 
 pub fn package_manager_checked() -> anyhow::Result<Arc<PackageManager>> {
@@ -15,10 +151,179 @@ pub fn package_manager_checked() -> anyhow::Result<Arc<PackageManager>> {
         .read()
         .unwrap()
         .as_ref()
-        .cloned()
+        .map(|s| s.pm.clone())
         .ok_or_else(|| anyhow::anyhow!("Package manager is not initialized!"))
 }
 
+/// Looks up a Wwise file by its reference ID in the index built by
+/// [initialize_package_manager], along with the package manager it belongs to.
+pub fn wwise_file_by_reference(id: u32) -> Option<(Arc<PackageManager>, WwiseFile)> {
+    let state = PACKAGE_MANAGER.read().unwrap();
+    let state = state.as_ref()?;
+    state.file(id).map(|file| (state.pm.clone(), file))
+}
+
 pub fn package_manager() -> Arc<PackageManager> {
     package_manager_checked().unwrap()
 }
+
+/// Size of a single (decompressed) package block. Entries are laid out contiguously across
+/// consecutive blocks, starting at `starting_block`/`starting_block_offset`.
+pub const PACKAGE_BLOCK_SIZE: usize = 0x40000;
+
+/// Number of decompressed blocks kept around by [read_tag_range].
+const BLOCK_CACHE_CAPACITY: usize = 32;
+
+/// Returns block `block_index` of package `pkg_id` of `index`, only calling `read` if the block is
+/// not among the last [BLOCK_CACHE_CAPACITY] blocks read, and not being read by another stream
+/// already.
+fn cached_block(
+    index: &WwisePackageIndex,
+    pkg_id: u16,
+    block_index: usize,
+    read: impl FnOnce() -> anyhow::Result<Arc<Vec<u8>>>,
+) -> anyhow::Result<Arc<Vec<u8>>> {
+    let key = (index.id, pkg_id, block_index);
+    {
+        let mut cache = BLOCK_CACHE.lock().unwrap();
+        if let Some(i) = cache.iter().position(|(k, _)| *k == key) {
+            let entry = cache.remove(i).unwrap();
+            let block = entry.1.clone();
+            cache.push_back(entry);
+            return Ok(block);
+        }
+    }
+
+    // Decompress outside of the lock, other streams may need blocks in the meantime. Streams
+    // reading the same window wait for a single decompression.
+    BLOCK_READS
+        .run(key, || {
+            let block = read().map_err(Arc::new)?;
+            // Cached before the flight ends, so a later reader finds it either way.
+            let mut cache = BLOCK_CACHE.lock().unwrap();
+            if !cache.iter().any(|(k, _)| *k == key) {
+                if cache.len() == BLOCK_CACHE_CAPACITY {
+                    cache.pop_front();
+                }
+                cache.push_back((key, block.clone()));
+            }
+            Ok(block)
+        })
+        .map_err(|e| anyhow::anyhow!("{e:#}"))
+}
+
+/// Reads the whole of `tag` like [PackageManager::read_tag], except that concurrent reads of the
+/// same tag (e.g. the bank list scanning packages while the player loads one of their banks)
+/// share a single read and decompression.
+///
+/// The result isn't cached: a read starting after the previous one completed reads again.
+pub fn read_tag_shared(index: &WwisePackageIndex, tag: TagHash) -> anyhow::Result<Arc<Vec<u8>>> {
+    let key = (index.id, tag.0);
+    TAG_READS
+        .run(key, || {
+            index.pm.read_tag(tag).map(Arc::new).map_err(Arc::new)
+        })
+        .map_err(|e| anyhow::anyhow!("{e:#}"))
+}
+
+/// Reads `out.len()` bytes of `tag` of the packages of `index`, starting at `offset` within the
+/// entry.
+///
+/// Only the package blocks covering the requested window are read and decompressed, instead of
+/// materializing the whole entry like [PackageManager::read_tag] does. Windows of a file that
+/// starts at the beginning of a block are whole blocks when its device allows it (see
+/// [crate::file_provider::WwiseFileProvider::block_size]); the others usually share their first
+/// and last blocks with the neighbouring windows, so the last blocks read are kept for the next
+/// window not to decompress them again.
+pub fn read_tag_range(
+    index: &WwisePackageIndex,
+    tag: TagHash,
+    offset: usize,
+    out: &mut [u8],
+) -> anyhow::Result<()> {
+    let pm = &index.pm;
+    let entry = pm
+        .get_entry(tag)
+        .ok_or_else(|| anyhow::anyhow!("Entry {tag} not found"))?;
+    anyhow::ensure!(
+        offset + out.len() <= entry.file_size as usize,
+        "Range {offset:#x}+{:#x} is out of bounds for {tag} (size {:#x})",
+        out.len(),
+        entry.file_size
+    );
+
+    let pkg = pm.get_or_load_pkg(tag.pkg_id())?;
+    let start = entry.starting_block_offset as usize + offset;
+    let mut block_index = entry.starting_block as usize + start / PACKAGE_BLOCK_SIZE;
+    let mut block_offset = start % PACKAGE_BLOCK_SIZE;
+    let mut written = 0;
+    while written < out.len() {
+        let block = cached_block(index, tag.pkg_id(), block_index, || {
+            pkg.get_block(block_index)
+        })?;
+        // A truncated or corrupt block must not panic, this runs under the I/O hook's callbacks.
+        let available = block.len().checked_sub(block_offset).unwrap_or(0);
+        anyhow::ensure!(
+            available > 0,
+            "Block {block_index} of {tag} is too short for offset {block_offset:#x} (size {:#x})",
+            block.len()
+        );
+        let len = std::cmp::min(available, out.len() - written);
+        out[written..written + len].copy_from_slice(&block[block_offset..block_offset + len]);
+
+        written += len;
+        block_index += 1;
+        block_offset = 0;
+    }
+
+    Ok(())
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::sync::atomic::AtomicUsize;
+    use std::time::Duration;
+
+    #[test]
+    fn single_flight_coalesces_concurrent_callers() {
+        const CALLERS: usize = 8;
+        let flights = SingleFlight::<u32, u32>::new();
+        let calls = AtomicUsize::new(0);
+
+        // Whether every caller holds the flight of `key`, besides the map itself.
+        let all_joined = |key| {
+            let in_flight = flights.in_flight.lock().unwrap();
+            in_flight
+                .get(&key)
+                .is_some_and(|f| Arc::strong_count(f) == CALLERS + 1)
+        };
+
+        let values: Vec<u32> = std::thread::scope(|s| {
+            let callers: Vec<_> = (0..CALLERS)
+                .map(|_| {
+                    s.spawn(|| {
+                        flights.run(7, || {
+                            calls.fetch_add(1, Ordering::Relaxed);
+                            // Completes only once the others wait on it, however late they are.
+                            while !all_joined(7) {
+                                std::thread::sleep(Duration::from_millis(1));
+                            }
+                            42
+                        })
+                    })
+                })
+                .collect();
+            callers.into_iter().map(|c| c.join().unwrap()).collect()
+        });
+
+        assert_eq!(values, vec![42; CALLERS]);
+        assert_eq!(calls.load(Ordering::Relaxed), 1);
+        assert!(flights.in_flight.lock().unwrap().is_empty());
+
+        // Nothing is kept once the flight landed: the next caller runs again.
+        assert_eq!(flights.run(7, || 43), 43);
+        // Nor shared across keys.
+        assert_eq!(flights.run(8, || 44), 44);
+    }
+}
@@ -0,0 +1,390 @@
+/*
+ * Copyright (c) 2022 Contributors to the Rrise project
+ */
+
+//! Per-bank prefetch manifests: the package file reads of the first seconds of playback of a
+//! bank, recorded by the tiger streaming manager, saved to disk and replayed the next time the
+//! bank is loaded to warm the file cache before its first event is posted.
+//!
+//! What a bank opened last time is the most reliable predictor of what it needs, including media
+//! that no hierarchy analysis can attribute to it. Call [begin_bank] once a bank is loaded, and
+//! [record_playback] when it starts playing:
+//!
+//! ```no_run
+//! # use rrise::prefetch_manifest;
+//! # use std::time::Duration;
+//! prefetch_manifest::set_manifest_dir("prefetch");
+//! # let bank_id = 0;
+//! prefetch_manifest::begin_bank(bank_id);
+//! // ... post the first event ...
+//! prefetch_manifest::record_playback(Duration::from_secs(10));
+//! ```
+
+use crate::bindings::root::{
+    GetTigerRecordedReads, StartTigerReadRecording, StopTigerReadRecording, TigerRecordedRead,
+};
+use crate::file_provider::file_provider;
+use crate::stream_mgr;
+use lazy_static::lazy_static;
+use log::{debug, warn};
+use std::collections::HashSet;
+use std::io::{Read, Write};
+use std::path::{Path, PathBuf};
+use std::sync::Mutex;
+use std::time::Duration;
+
+const MANIFEST_MAGIC: &[u8; 4] = b"TPM1";
+
+/// A range of a package file read during a recording.
+#[derive(Debug, Copy, Clone, PartialEq, Eq)]
+pub struct RecordedRead {
+    pub file_id: u32,
+    pub offset: u64,
+    pub size: u32,
+    /// Since the recording started.
+    pub at: Duration,
+}
+
+impl From<&TigerRecordedRead> for RecordedRead {
+    fn from(read: &TigerRecordedRead) -> Self {
+        Self {
+            file_id: read.fileID,
+            offset: read.uOffset,
+            size: read.uSize,
+            at: Duration::from_millis(read.uTimeMs as u64),
+        }
+    }
+}
+
+/// The reads of a bank's first seconds of playback, in the order they happened.
+#[derive(Debug, Clone, Default, PartialEq)]
+pub struct PrefetchManifest {
+    pub bank_id: u32,
+    pub reads: Vec<RecordedRead>,
+}
+
+impl PrefetchManifest {
+    /// Where the manifest of `bank_id` is kept in `dir`.
+    pub fn path(dir: &Path, bank_id: u32) -> PathBuf {
+        dir.join(format!("{bank_id:08x}.tpm"))
+    }
+
+    pub fn load(path: &Path) -> std::io::Result<Self> {
+        let data = std::fs::read(path)?;
+        let mut cur = data.as_slice();
+        let invalid = || std::io::Error::new(std::io::ErrorKind::InvalidData, "invalid manifest");
+
+        let mut magic = [0; 4];
+        cur.read_exact(&mut magic)?;
+        if &magic != MANIFEST_MAGIC {
+            return Err(invalid());
+        }
+        let bank_id = read_u32(&mut cur)?;
+        let count = read_u32(&mut cur)? as usize;
+        if cur.len() != count * 20 {
+            return Err(invalid());
+        }
+
+        let mut reads = Vec::with_capacity(count);
+        for _ in 0..count {
+            reads.push(RecordedRead {
+                file_id: read_u32(&mut cur)?,
+                offset: read_u64(&mut cur)?,
+                size: read_u32(&mut cur)?,
+                at: Duration::from_millis(read_u32(&mut cur)? as u64),
+            });
+        }
+
+        Ok(Self { bank_id, reads })
+    }
+
+    /// Writes the manifest to `path`, replacing the previous one only once it is complete.
+    pub fn save(&self, path: &Path) -> std::io::Result<()> {
+        let mut data = Vec::with_capacity(12 + self.reads.len() * 20);
+        data.write_all(MANIFEST_MAGIC)?;
+        data.write_all(&self.bank_id.to_le_bytes())?;
+        data.write_all(&(self.reads.len() as u32).to_le_bytes())?;
+        for read in &self.reads {
+            data.write_all(&read.file_id.to_le_bytes())?;
+            data.write_all(&read.offset.to_le_bytes())?;
+            data.write_all(&read.size.to_le_bytes())?;
+            data.write_all(&(read.at.as_millis() as u32).to_le_bytes())?;
+        }
+
+        let tmp = path.with_extension("tpm.tmp");
+        std::fs::write(&tmp, data)?;
+        std::fs::rename(tmp, path)
+    }
+
+    /// The files read, each once, in the order of their first read.
+    pub fn files(&self) -> Vec<u32> {
+        let mut seen = HashSet::new();
+        self.reads
+            .iter()
+            .map(|r| r.file_id)
+            .filter(|id| seen.insert(*id))
+            .collect()
+    }
+
+    /// Queues the files of the manifest into the file cache, see
+    /// [stream_mgr::prefetch_tiger_files], first read first, as many as its budget holds.
+    ///
+    /// The cache holds whole files: a file is prefetched whole even if only its beginning was
+    /// read during the recording.
+    pub fn replay(&self) {
+        let budget = stream_mgr::tiger_file_cache_stats().uBudgetBytes as usize;
+        let provider = file_provider();
+        let mut total = 0;
+        let mut file_ids = vec![];
+        for file_id in self.files() {
+            let Some(size) = provider.file_size(file_id) else {
+                continue;
+            };
+            if total + size > budget {
+                break;
+            }
+            total += size;
+            file_ids.push(file_id);
+        }
+
+        debug!(
+            "Replaying the prefetch manifest of bank {}: {} files, {total} bytes",
+            self.bank_id,
+            file_ids.len()
+        );
+        stream_mgr::prefetch_tiger_files(&file_ids, false);
+    }
+}
+
+fn read_u32(cur: &mut &[u8]) -> std::io::Result<u32> {
+    let mut bytes = [0; 4];
+    cur.read_exact(&mut bytes)?;
+    Ok(u32::from_le_bytes(bytes))
+}
+
+fn read_u64(cur: &mut &[u8]) -> std::io::Result<u64> {
+    let mut bytes = [0; 8];
+    cur.read_exact(&mut bytes)?;
+    Ok(u64::from_le_bytes(bytes))
+}
+
+#[derive(Default)]
+struct ManifestState {
+    dir: Option<PathBuf>,
+    /// Bank of the last [begin_bank], until its playback is recorded.
+    bank_id: Option<u32>,
+    /// Bank being recorded, and the generation of its recording.
+    recording: Option<(u32, u64)>,
+    generation: u64,
+}
+
+lazy_static! {
+    static ref STATE: Mutex<ManifestState> = Mutex::new(ManifestState::default());
+}
+
+/// Sets the directory manifests are read from and saved to, creating it if needed. Nothing is
+/// recorded or replayed until it is set.
+pub fn set_manifest_dir(dir: impl Into<PathBuf>) {
+    let dir = dir.into();
+    if let Err(e) = std::fs::create_dir_all(&dir) {
+        warn!("Couldn't create the prefetch manifest directory {dir:?}: {e}");
+        return;
+    }
+    STATE.lock().unwrap().dir = Some(dir);
+}
+
+/// To be called once bank `bank_id` is loaded: replays its manifest, if there is one, on a
+/// background thread, and makes it the bank [record_playback] records.
+pub fn begin_bank(bank_id: u32) {
+    let mut state = STATE.lock().unwrap();
+    let Some(dir) = state.dir.clone() else {
+        return;
+    };
+    state.bank_id = Some(bank_id);
+
+    std::thread::Builder::new()
+        .name("prefetch_manifest".to_string())
+        .spawn(move || {
+            let path = PrefetchManifest::path(&dir, bank_id);
+            match PrefetchManifest::load(&path) {
+                Ok(manifest) => manifest.replay(),
+                Err(e) if e.kind() == std::io::ErrorKind::NotFound => {}
+                Err(e) => warn!("Couldn't read the prefetch manifest {path:?}: {e}"),
+            }
+        })
+        .unwrap();
+}
+
+/// To be called when the bank of the last [begin_bank] starts playing: records the package file
+/// reads of the next `duration` and saves them as its manifest, replacing the previous one.
+/// Only the first call after [begin_bank] records.
+///
+/// A recording still running is cut short and saved.
+pub fn record_playback(duration: Duration) {
+    finish_recording();
+
+    let mut state = STATE.lock().unwrap();
+    let Some(bank_id) = state.bank_id.take() else {
+        return;
+    };
+    state.generation += 1;
+    let generation = state.generation;
+    state.recording = Some((bank_id, generation));
+    unsafe {
+        StartTigerReadRecording(duration.as_millis() as u32);
+    }
+
+    std::thread::Builder::new()
+        .name("prefetch_manifest".to_string())
+        .spawn(move || {
+            std::thread::sleep(duration);
+            // Unless another recording replaced this one meanwhile.
+            finish(Some(generation));
+        })
+        .unwrap();
+}
+
+/// Stops the current recording, if any, and saves its manifest.
+pub fn finish_recording() {
+    finish(None);
+}
+
+/// Finishes the current recording if it is of `generation`, or whichever it is for `None`.
+fn finish(generation: Option<u64>) {
+    let (bank_id, dir) = {
+        let mut state = STATE.lock().unwrap();
+        match state.recording {
+            Some((bank_id, current)) if generation.is_none_or(|g| g == current) => {
+                state.recording = None;
+                (bank_id, state.dir.clone())
+            }
+            _ => return,
+        }
+    };
+
+    unsafe {
+        StopTigerReadRecording();
+    }
+    let reads = recorded_reads();
+    if reads.is_empty() {
+        return;
+    }
+
+    let manifest = PrefetchManifest { bank_id, reads };
+    if let Some(dir) = dir {
+        let path = PrefetchManifest::path(&dir, bank_id);
+        match manifest.save(&path) {
+            Ok(()) => debug!(
+                "Saved the prefetch manifest of bank {bank_id}: {} reads of {} files",
+                manifest.reads.len(),
+                manifest.files().len()
+            ),
+            Err(e) => warn!("Couldn't save the prefetch manifest {path:?}: {e}"),
+        }
+    }
+}
+
+/// The reads of the last recording of the tiger streaming manager.
+pub fn recorded_reads() -> Vec<RecordedRead> {
+    unsafe {
+        let count = GetTigerRecordedReads(std::ptr::null_mut(), 0);
+        let mut reads: Vec<TigerRecordedRead> = vec![std::mem::zeroed(); count as usize];
+        let count = GetTigerRecordedReads(reads.as_mut_ptr(), count).min(count);
+        reads.truncate(count as usize);
+        reads.iter().map(RecordedRead::from).collect()
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn test_dir(name: &str) -> PathBuf {
+        let dir = std::env::temp_dir().join(format!(
+            "rrise-prefetch-manifest-{}-{name}",
+            std::process::id()
+        ));
+        std::fs::create_dir_all(&dir).unwrap();
+        dir
+    }
+
+    #[test]
+    fn save_load_round_trip() {
+        let dir = test_dir("round-trip");
+        let manifest = PrefetchManifest {
+            bank_id: 0xdeadbeef,
+            reads: vec![
+                RecordedRead {
+                    file_id: 1,
+                    offset: 0,
+                    size: 0x40000,
+                    at: Duration::from_millis(0),
+                },
+                RecordedRead {
+                    file_id: 2,
+                    offset: 0x1_0000_0000,
+                    size: 512,
+                    at: Duration::from_millis(1500),
+                },
+                RecordedRead {
+                    file_id: 1,
+                    offset: 0x40000,
+                    size: 0x40000,
+                    at: Duration::from_millis(3000),
+                },
+            ],
+        };
+
+        let path = PrefetchManifest::path(&dir, manifest.bank_id);
+        manifest.save(&path).unwrap();
+        assert!(!path.with_extension("tpm.tmp").exists());
+        let loaded = PrefetchManifest::load(&path).unwrap();
+        assert_eq!(loaded, manifest);
+        assert_eq!(loaded.files(), vec![1, 2]);
+
+        std::fs::remove_dir_all(dir).unwrap();
+    }
+
+    #[test]
+    fn load_rejects_bad_magic() {
+        let dir = test_dir("bad-magic");
+        let path = PrefetchManifest::path(&dir, 1);
+        let mut data = b"TPM0".to_vec();
+        data.extend_from_slice(&1u32.to_le_bytes());
+        data.extend_from_slice(&0u32.to_le_bytes());
+        std::fs::write(&path, data).unwrap();
+
+        let e = PrefetchManifest::load(&path).unwrap_err();
+        assert_eq!(e.kind(), std::io::ErrorKind::InvalidData);
+
+        std::fs::remove_dir_all(dir).unwrap();
+    }
+
+    #[test]
+    fn load_rejects_bad_length() {
+        let dir = test_dir("bad-length");
+        let path = PrefetchManifest::path(&dir, 1);
+        let manifest = PrefetchManifest {
+            bank_id: 1,
+            reads: vec![RecordedRead {
+                file_id: 1,
+                offset: 0,
+                size: 512,
+                at: Duration::ZERO,
+            }],
+        };
+        manifest.save(&path).unwrap();
+
+        // Truncated, then with trailing bytes.
+        let data = std::fs::read(&path).unwrap();
+        for len in [data.len() - 1, data.len() + 1] {
+            let mut bad = data.clone();
+            bad.resize(len, 0);
+            std::fs::write(&path, bad).unwrap();
+            let e = PrefetchManifest::load(&path).unwrap_err();
+            assert_eq!(e.kind(), std::io::ErrorKind::InvalidData);
+        }
+
+        std::fs::remove_dir_all(dir).unwrap();
+    }
+}
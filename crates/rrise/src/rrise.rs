@@ -6,10 +6,12 @@
 
 #[cfg(not(wwrelease))]
 pub mod communication;
+pub mod file_provider;
 pub mod game_syncs;
 pub mod memory_mgr;
 pub mod music_engine;
 pub mod package_manager;
+pub mod prefetch_manifest;
 pub mod query_params;
 pub mod settings;
 pub mod sound_engine;
@@ -768,35 +770,34 @@ pub enum AkCodecId {
 }
 
 #[unsafe(no_mangle)]
-pub unsafe extern "C" fn ddumbe_get_wwise_file_size_by_id(id: u32) -> usize {
-    package_manager::package_manager()
-        .get_all_by_reference(id)
-        .first()
-        .map(|(_, e)| e.file_size as usize)
-        .unwrap_or(usize::MAX)
+pub unsafe extern "C" fn ddumbe_get_wwise_file_size_by_id(
+    source: *const std::ffi::c_void,
+    id: u32,
+) -> usize {
+    file_provider::with_file_source(source, |provider| provider.file_size(id)).unwrap_or(usize::MAX)
+}
+
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn ddumbe_get_wwise_file_block_size_by_id(
+    source: *const std::ffi::c_void,
+    id: u32,
+) -> u32 {
+    file_provider::with_file_source(source, |provider| provider.block_size(id)) as u32
 }
 
 #[unsafe(no_mangle)]
-pub unsafe extern "C" fn ddumbe_read_wwise_file_by_id(
+pub unsafe extern "C" fn ddumbe_read_wwise_file_range_by_id(
+    source: *const std::ffi::c_void,
     id: u32,
+    offset: u64,
     buffer: *mut u8,
     size: usize,
 ) -> AkResult {
-    let Some((t, _)) = package_manager::package_manager()
-        .get_all_by_reference(id)
-        .first()
-        .cloned()
-    else {
-        return AkResult::AK_FileNotFound;
-    };
-    let Ok(data) = package_manager::package_manager().read_tag(t) else {
-        return AkResult::AK_Fail;
-    };
-
-    let len = data.len();
-    let to_copy = std::cmp::min(len, size);
-    std::ptr::copy_nonoverlapping(data.as_ptr(), buffer, to_copy);
-    AkResult::AK_Success
+    let out = std::slice::from_raw_parts_mut(buffer, size);
+    match file_provider::with_file_source(source, |provider| provider.read_range(id, offset, out)) {
+        Ok(()) => AkResult::AK_Success,
+        Err(e) => e,
+    }
 }
 
 #[allow(non_snake_case)]
@@ -814,6 +815,7 @@ pub unsafe extern "C" fn monitoring_callback(
         in_playingID,
         in_gameObjID
     );
+    stream_mgr::record_monitor_error(in_eErrorCode, in_playingID, in_gameObjID);
 }
 
 pub mod monitor {
@@ -3,11 +3,29 @@
  */
 
 use crate::bindings::root::{
-    AddBasePath, InitDefaultStreamMgr, InitTigerStreamMgr, TermDefaultStreamMgr,
-    TermTigerStreamMgr, AK,
+    AddBasePath, AddTigerContextStreamDevice, AddTigerStreamDevice, ClearTigerNegativeLookupCache,
+    CloseTigerStdStream, CreateTigerStreamContext, DestroyTigerStreamContext,
+    FlushTigerWriteBehind, GetTigerBufferPoolStats, GetTigerContextFileCacheStats,
+    GetTigerContextIoStats, GetTigerFaultStats, GetTigerFileCacheStats, GetTigerIoStats,
+    GetTigerNegativeLookupHits, GetTigerPinnedFileStatus, GetTigerWriteBehindStats,
+    InitDefaultStreamMgr, InitTigerLayeredResolver, InitTigerStreamMgr, InitTigerStreamMgrDeferred,
+    InitTigerWriteBehind, IsTigerIoUringActive, OpenTigerContextStdStream, OpenTigerStdStream,
+    PinTigerStreamedFile, PrefetchTigerFiles, ReadTigerStdStream, RecordTigerMonitorError,
+    ResetTigerFaultStats, ResetTigerIoStats, SetTigerBufferPoolMaxRetained,
+    SetTigerContextFaultProfile, SetTigerContextFileCacheBudget, SetTigerFaultProfile,
+    SetTigerFaultSeed, SetTigerFileCacheBudget, SetTigerFilePrefetchThreads, SetTigerIoTraceLevel,
+    TermDefaultStreamMgr, TermTigerStreamMgr, TigerFaultLatency, TigerFaultProfile,
+    UnpinTigerStreamedFile, UpdateTigerStreamedFilePriority, AK, AK_SCHEDULER_BLOCKING,
+    AK_SCHEDULER_DEFERRED_LINED_UP, TIGER_DIRECT_IO_DEFAULT_ALIGNMENT,
 };
+use crate::file_provider::{FileSource, WwiseFileProvider};
 use crate::settings::{AkDeviceSettings, AkStreamMgrSettings};
-use crate::{ak_call_result, to_os_char, AkResult};
+use crate::{ak_call_result, to_os_char, AkGameObjectID, AkPlayingID, AkPriority, AkResult};
+use lazy_static::lazy_static;
+use std::collections::VecDeque;
+use std::marker::PhantomData;
+use std::sync::{Arc, Mutex};
+use std::time::{Duration, Instant};
 
 /// Stream Manager factory.
 ///
@@ -41,16 +59,758 @@ pub fn init_default_stream_mgr(
     ak_call_result![InitDefaultStreamMgr(&device_settings)]
 }
 
+/// Which I/O hook backs the tiger streaming manager's device.
+#[derive(Debug, Default, Copy, Clone, PartialEq, Eq)]
+pub enum TigerIoScheduler {
+    /// Every transfer is served synchronously on the Stream Manager's I/O thread.
+    #[default]
+    Blocking,
+    /// Transfers are queued and completed by `workers` threads, so several streams and bank loads
+    /// can read and decompress package data in parallel. Queued transfers are served earliest
+    /// deadline first, then by priority.
+    Deferred { workers: u32 },
+    /// Same as [TigerIoScheduler::Deferred], but reads of loose (name-resolved) files are
+    /// submitted to the kernel through io_uring, with up to `queue_depth` of them in flight,
+    /// instead of costing a worker and a syscall each.
+    ///
+    /// Falls back to [TigerIoScheduler::Deferred] when io_uring is not available (non-Linux
+    /// platforms, old kernels, or seccomp policies rejecting it), see [tiger_io_uring_active].
+    DeferredUring { workers: u32, queue_depth: u32 },
+}
+
 /// Initializes the tiger streaming manager
+///
+/// `device_settings.scheduler_type_flags` is overridden to match `scheduler`. For
+/// [TigerIoScheduler::Deferred], `device_settings.max_concurrent_io` is raised to at least the
+/// number of workers so none of them sit idle.
+///
+/// Streamed package files that start at the beginning of a package block are read in whole
+/// blocks when `device_settings.granularity` is a multiple of [PACKAGE_BLOCK_SIZE], at the cost
+/// of fewer streaming buffers for the same I/O memory.
+///
+/// With `direct_io`, loose files are read without going through the OS page cache (`O_DIRECT`,
+/// or `F_NOCACHE` on Apple platforms), so long renders don't evict everything else from it, and
+/// `device_settings.io_memory_alignment` is raised to at least [TIGER_DIRECT_IO_DEFAULT_ALIGNMENT]
+/// so the streaming buffers can be read into as-is. Ignored on Windows.
+///
+/// [PACKAGE_BLOCK_SIZE]: crate::package_manager::PACKAGE_BLOCK_SIZE
 pub fn init_tiger_stream_mgr(
     stream_mgr_settings: &AkStreamMgrSettings,
     device_settings: &mut AkDeviceSettings,
+    scheduler: TigerIoScheduler,
+    direct_io: bool,
 ) -> Result<(), AkResult> {
     init(stream_mgr_settings)?;
+
+    let (workers, queue_depth) =
+        prepare_tiger_device_settings(device_settings, scheduler, direct_io);
+    let device_settings = device_settings.as_ak();
+    if workers == 0 {
+        ak_call_result![InitTigerStreamMgr(&device_settings, direct_io)]
+    } else {
+        ak_call_result![InitTigerStreamMgrDeferred(
+            &device_settings,
+            workers,
+            queue_depth,
+            direct_io
+        )]
+    }
+}
+
+/// Adjusts `device_settings` to `scheduler` and `direct_io` as documented on
+/// [init_tiger_stream_mgr]. Returns the number of workers (0 for a blocking hook) and the io_uring
+/// queue depth.
+fn prepare_tiger_device_settings(
+    device_settings: &mut AkDeviceSettings,
+    scheduler: TigerIoScheduler,
+    direct_io: bool,
+) -> (u32, u32) {
+    prepare_package_device_settings(device_settings);
+    if direct_io {
+        device_settings.io_memory_alignment = device_settings
+            .io_memory_alignment
+            .max(TIGER_DIRECT_IO_DEFAULT_ALIGNMENT);
+    }
+
+    match scheduler {
+        TigerIoScheduler::Blocking => {
+            device_settings.scheduler_type_flags = AK_SCHEDULER_BLOCKING;
+            (0, 0)
+        }
+        TigerIoScheduler::Deferred { workers } => {
+            device_settings.scheduler_type_flags = AK_SCHEDULER_DEFERRED_LINED_UP;
+            device_settings.max_concurrent_io = device_settings.max_concurrent_io.max(workers);
+            (workers, 0)
+        }
+        TigerIoScheduler::DeferredUring {
+            workers,
+            queue_depth,
+        } => {
+            device_settings.scheduler_type_flags = AK_SCHEDULER_DEFERRED_LINED_UP;
+            device_settings.max_concurrent_io =
+                device_settings.max_concurrent_io.max(workers + queue_depth);
+            (workers, queue_depth)
+        }
+    }
+}
+
+/// Settings every device reading package files needs.
+fn prepare_package_device_settings(device_settings: &mut AkDeviceSettings) {
     device_settings.use_stream_cache = true;
+}
+
+/// Classes of files that can be given a device of their own with [add_tiger_stream_device].
+pub use crate::bindings::root::TigerDeviceClass;
+
+/// Gives a class of files a streaming device of its own, so e.g. music streams get dedicated I/O
+/// memory, granularity and I/O thread priority instead of queuing behind bank loads. Files are
+/// routed by the flags the sound engine opens them with: banks by codec, streamed media by
+/// being automatic streams. Classes without a device of their own use the default one.
+///
+/// Must be called after [init_tiger_stream_mgr] and before any file is opened. As there, whole
+/// package blocks are read only with a `device_settings.granularity` multiple of
+/// [PACKAGE_BLOCK_SIZE], while the scheduler type and I/O memory alignment are overridden to match
+/// the default device.
+///
+/// [PACKAGE_BLOCK_SIZE]: crate::package_manager::PACKAGE_BLOCK_SIZE
+pub fn add_tiger_stream_device(
+    class: TigerDeviceClass,
+    device_settings: &mut AkDeviceSettings,
+) -> Result<(), AkResult> {
+    prepare_package_device_settings(device_settings);
+
+    let device_settings = device_settings.as_ak();
+    ak_call_result![AddTigerStreamDevice(class, &device_settings)]
+}
+
+/// Whether loose-file reads of the tiger streaming manager go through io_uring, i.e. it was
+/// initialized with [TigerIoScheduler::DeferredUring] and io_uring is available.
+pub fn tiger_io_uring_active() -> bool {
+    unsafe { IsTigerIoUringActive() }
+}
+
+/// Chains the default file-package device behind the tiger streaming manager, so files that are
+/// not in the packages are looked up in its base paths (see [add_base_path]) instead of failing.
+///
+/// Must be called after [init_tiger_stream_mgr]. The default device always uses a blocking
+/// scheduler, `device_settings.scheduler_type_flags` is overridden accordingly.
+///
+/// Files a device didn't find are remembered, so opening missing media again skips straight past
+/// it. This negative-lookup cache is cleared when the language changes, and by
+/// [clear_tiger_negative_lookup_cache].
+pub fn add_tiger_default_fallback(device_settings: &mut AkDeviceSettings) -> Result<(), AkResult> {
+    device_settings.use_stream_cache = true;
+    device_settings.scheduler_type_flags = AK_SCHEDULER_BLOCKING;
+
+    let device_settings = device_settings.as_ak();
+    ak_call_result![InitTigerLayeredResolver(&device_settings)]
+}
+
+/// Forgets which files were not found, e.g. after files were added to a base path or the packages
+/// changed. See [add_tiger_default_fallback].
+pub fn clear_tiger_negative_lookup_cache() {
+    unsafe {
+        ClearTigerNegativeLookupCache();
+    }
+}
+
+/// Number of device lookups skipped thanks to the negative-lookup cache since
+/// [add_tiger_default_fallback].
+pub fn tiger_negative_lookup_hits() -> u64 {
+    unsafe { GetTigerNegativeLookupHits() }
+}
+
+/// How much of a pinned file is in the stream cache, see [tiger_pinned_file_status].
+#[derive(Debug, Default, Copy, Clone, PartialEq)]
+pub struct PinnedFileStatus {
+    /// Share of the file that is buffered, in percent.
+    pub percent_buffered: f32,
+    /// Whether the cache is full (see `max_cache_pinned_bytes` in [AkDeviceSettings]), in which
+    /// case the rest of the file won't be buffered until other files are unpinned.
+    pub cache_full: bool,
+}
+
+/// Pins the streamed media `file_id` in the stream cache: it is read into the cache ahead of
+/// playback and stays resident until unpinned, so starting it (e.g. on a music switch) doesn't
+/// wait for I/O. Files pinned with a higher `priority` evict lower ones when the cache is full.
+///
+/// Requires a device initialized with `use_stream_cache`, which [init_tiger_stream_mgr] forces.
+/// Each pin must be balanced by an [unpin_tiger_streamed_file] with the same priority.
+pub fn pin_tiger_streamed_file(file_id: u32, priority: AkPriority) -> Result<(), AkResult> {
+    ak_call_result![PinTigerStreamedFile(file_id, priority)]
+}
+
+/// Releases a pin taken with [pin_tiger_streamed_file].
+pub fn unpin_tiger_streamed_file(file_id: u32, priority: AkPriority) -> Result<(), AkResult> {
+    ak_call_result![UnpinTigerStreamedFile(file_id, priority)]
+}
+
+/// Changes the priority of a pin taken with [pin_tiger_streamed_file] at `old_priority`.
+pub fn update_tiger_streamed_file_priority(
+    file_id: u32,
+    priority: AkPriority,
+    old_priority: AkPriority,
+) -> Result<(), AkResult> {
+    ak_call_result![UpdateTigerStreamedFilePriority(
+        file_id,
+        priority,
+        old_priority
+    )]
+}
+
+/// Pins every file of `file_ids`, typically the `audio_id`s of a music bank's tracks, see
+/// [pin_tiger_streamed_file]. Stops at the first failure, returning it after unpinning the files
+/// it had pinned.
+pub fn pin_tiger_streamed_files(
+    file_ids: impl IntoIterator<Item = u32>,
+    priority: AkPriority,
+) -> Result<Vec<u32>, AkResult> {
+    let mut pinned = vec![];
+    for file_id in file_ids {
+        if let Err(e) = pin_tiger_streamed_file(file_id, priority) {
+            unpin_tiger_streamed_files(pinned, priority);
+            return Err(e);
+        }
+        pinned.push(file_id);
+    }
+
+    Ok(pinned)
+}
+
+/// Releases the pins taken with [pin_tiger_streamed_files]. Files that were not pinned are
+/// skipped.
+pub fn unpin_tiger_streamed_files(file_ids: impl IntoIterator<Item = u32>, priority: AkPriority) {
+    for file_id in file_ids {
+        let _ = unpin_tiger_streamed_file(file_id, priority);
+    }
+}
+
+/// How much of a file pinned with [pin_tiger_streamed_file] is buffered.
+pub fn tiger_pinned_file_status(file_id: u32) -> Result<PinnedFileStatus, AkResult> {
+    let mut status = PinnedFileStatus::default();
+    ak_call_result![GetTigerPinnedFileStatus(
+        file_id,
+        &mut status.percent_buffered,
+        &mut status.cache_full
+    ) => status]
+}
+
+/// Hit/miss/eviction counters of the tiger streaming manager's file cache.
+pub use crate::bindings::root::TigerFileCacheStats;
+
+/// Sets the memory budget of the tiger streaming manager's file cache, in bytes.
+///
+/// Package files that are not streamed (e.g. banks) stay resident after being closed, so that
+/// reopening them doesn't read and decompress them from the package again. Closed files are
+/// evicted, least recently used first, while the cache is over budget. Pass 0 to disable caching.
+///
+/// *Warning* Must be called after [init_tiger_stream_mgr].
+pub fn set_tiger_file_cache_budget(budget_bytes: usize) {
+    unsafe {
+        SetTigerFileCacheBudget(budget_bytes);
+    }
+}
+
+/// Returns the counters of the tiger streaming manager's file cache.
+///
+/// *Warning* Must be called after [init_tiger_stream_mgr].
+pub fn tiger_file_cache_stats() -> TigerFileCacheStats {
+    unsafe {
+        let mut stats: TigerFileCacheStats = std::mem::zeroed();
+        GetTigerFileCacheStats(&mut stats);
+        stats
+    }
+}
+
+/// Queues `file_ids` to be read whole into the tiger streaming manager's file cache, in order,
+/// on its background threads. Files already resident or being read are skipped.
+///
+/// Streamed media is normally read from the packages window by window as it plays; a streamed
+/// file that is resident when opened is read from the cache instead, so warming the files a
+/// music switch may reach lets it start without waiting on package reads. `urgent` files go
+/// ahead of the ones queued before, e.g. for the state the game just switched to. Prefetched files
+/// count against the budget of [set_tiger_file_cache_budget] and are evicted like any other.
+///
+/// *Warning* Must be called after [init_tiger_stream_mgr].
+pub fn prefetch_tiger_files(file_ids: &[u32], urgent: bool) {
+    unsafe {
+        PrefetchTigerFiles(file_ids.as_ptr(), file_ids.len() as u32, urgent);
+    }
+}
+
+/// Sets how many background threads read the files queued by [prefetch_tiger_files], 1 by
+/// default. Package reads decompress on the reading thread, so a few threads help warm many
+/// files at once.
+///
+/// *Warning* Must be called after [init_tiger_stream_mgr].
+pub fn set_tiger_file_prefetch_threads(count: u32) {
+    unsafe {
+        SetTigerFilePrefetchThreads(count);
+    }
+}
+
+/// A blocking standard stream reading a Wwise file through the tiger streaming manager, from the
+/// Stream Manager down to the [crate::file_provider]. Meant for tools and benchmarks.
+///
+/// Streams opened through a [TigerStreamContext] borrow it.
+pub struct TigerStdStream<'a> {
+    stream: *mut std::ffi::c_void,
+    _context: PhantomData<&'a TigerStreamContext>,
+}
+
+// Wwise standard streams may be used from any thread, one at a time.
+unsafe impl Send for TigerStdStream<'_> {}
+
+impl TigerStdStream<'static> {
+    /// Opens file `file_id` synchronously. With `streamed`, it is opened like streamed media
+    /// (read from its package window by window), otherwise like a bank (read whole into the file
+    /// cache on open).
+    ///
+    /// *Warning* Must be called after [init_tiger_stream_mgr].
+    pub fn open(file_id: u32, streamed: bool) -> Result<Self, AkResult> {
+        let mut stream = std::ptr::null_mut();
+        ak_call_result![OpenTigerStdStream(file_id, streamed, &mut stream) => Self {
+            stream,
+            _context: PhantomData,
+        }]
+    }
+}
+
+impl TigerStdStream<'_> {
+    /// Reads the next `buf.len()` bytes, returning how many were read: less than requested only
+    /// at the end of the file.
+    ///
+    /// `buf.len()` must be a multiple of the file's block size: [PACKAGE_BLOCK_SIZE] for streamed
+    /// files read in whole blocks, see [init_tiger_stream_mgr].
+    ///
+    /// [PACKAGE_BLOCK_SIZE]: crate::package_manager::PACKAGE_BLOCK_SIZE
+    pub fn read(&mut self, buf: &mut [u8]) -> Result<usize, AkResult> {
+        let mut read = 0;
+        ak_call_result![ReadTigerStdStream(
+            self.stream,
+            buf.as_mut_ptr() as *mut _,
+            buf.len() as u32,
+            &mut read
+        ) => read as usize]
+    }
+}
+
+impl Drop for TigerStdStream<'_> {
+    fn drop(&mut self) {
+        unsafe {
+            CloseTigerStdStream(self.stream);
+        }
+    }
+}
+
+/// An independent tiger I/O configuration: its own hook, streaming devices, file cache, counters
+/// and [WwiseFileProvider], so test harnesses and batch tools can run several configurations
+/// side by side in one process.
+///
+/// The Stream Manager and the sound engine stay process-wide: the sound engine is served by the
+/// default configuration of [init_tiger_stream_mgr], a context only serves the standard streams
+/// opened through [TigerStreamContext::open_std]. Contexts must be created after the Stream
+/// Manager ([init] or [init_tiger_stream_mgr]) and dropped before [term_tiger_stream_mgr].
+pub struct TigerStreamContext {
+    context: *mut std::ffi::c_void,
+    /// Handed to the C++ side, which reads through it until the context is destroyed.
+    _source: Option<FileSource>,
+}
+
+// The C++ context is internally synchronized.
+unsafe impl Send for TigerStreamContext {}
+unsafe impl Sync for TigerStreamContext {}
+
+impl TigerStreamContext {
+    /// Creates a context reading files from `provider`, or from the process-wide provider (see
+    /// [crate::file_provider::set_file_provider]) if `None`. `device_settings` are adjusted as by
+    /// [init_tiger_stream_mgr].
+    pub fn new(
+        device_settings: &mut AkDeviceSettings,
+        scheduler: TigerIoScheduler,
+        direct_io: bool,
+        provider: Option<Arc<dyn WwiseFileProvider>>,
+    ) -> Result<Self, AkResult> {
+        let source: Option<FileSource> = provider.map(Box::new);
+        let source_ptr = source.as_deref().map_or(std::ptr::null(), |provider| {
+            provider as *const Arc<dyn WwiseFileProvider> as *const std::ffi::c_void
+        });
+
+        let (workers, queue_depth) =
+            prepare_tiger_device_settings(device_settings, scheduler, direct_io);
+        let device_settings = device_settings.as_ak();
+        let mut context = std::ptr::null_mut();
+        ak_call_result![CreateTigerStreamContext(
+            &device_settings,
+            workers,
+            queue_depth,
+            direct_io,
+            source_ptr,
+            &mut context
+        ) => Self {
+            context,
+            _source: source,
+        }]
+    }
+
+    /// Gives a class of files a device of its own in this context, see
+    /// [add_tiger_stream_device].
+    pub fn add_device(
+        &self,
+        class: TigerDeviceClass,
+        device_settings: &mut AkDeviceSettings,
+    ) -> Result<(), AkResult> {
+        prepare_package_device_settings(device_settings);
+
+        let device_settings = device_settings.as_ak();
+        ak_call_result![AddTigerContextStreamDevice(
+            self.context,
+            class,
+            &device_settings
+        )]
+    }
+
+    /// Opens file `file_id` through this context, see [TigerStdStream::open].
+    pub fn open_std(&self, file_id: u32, streamed: bool) -> Result<TigerStdStream<'_>, AkResult> {
+        let mut stream = std::ptr::null_mut();
+        ak_call_result![OpenTigerContextStdStream(self.context, file_id, streamed, &mut stream) => TigerStdStream {
+            stream,
+            _context: PhantomData,
+        }]
+    }
+
+    /// See [set_tiger_file_cache_budget].
+    pub fn set_file_cache_budget(&self, budget_bytes: usize) {
+        unsafe {
+            SetTigerContextFileCacheBudget(self.context, budget_bytes);
+        }
+    }
+
+    /// See [tiger_file_cache_stats].
+    pub fn file_cache_stats(&self) -> TigerFileCacheStats {
+        unsafe {
+            let mut stats: TigerFileCacheStats = std::mem::zeroed();
+            GetTigerContextFileCacheStats(self.context, &mut stats);
+            stats
+        }
+    }
+
+    /// See [tiger_io_stats].
+    pub fn io_stats(&self, class: TigerDeviceClass) -> TigerIoDeviceStats {
+        unsafe {
+            let mut stats: TigerIoDeviceStats = std::mem::zeroed();
+            GetTigerContextIoStats(self.context, class, &mut stats);
+            stats
+        }
+    }
+
+    /// See [set_tiger_fault_profile].
+    pub fn set_fault_profile(&self, class: TigerDeviceClass, profile: Option<&FaultProfile>) {
+        let profile = profile.map(FaultProfile::as_ak);
+        unsafe {
+            SetTigerContextFaultProfile(
+                self.context,
+                class,
+                profile.as_ref().map_or(std::ptr::null(), |p| p as *const _),
+            );
+        }
+    }
+}
+
+impl Drop for TigerStreamContext {
+    fn drop(&mut self) {
+        unsafe {
+            DestroyTigerStreamContext(self.context);
+        }
+    }
+}
+
+/// Counters of the write-behind device, see [add_tiger_write_behind_device].
+pub use crate::bindings::root::TigerWriteBehindStats;
+
+/// Default `max_pending_bytes` of [add_tiger_write_behind_device].
+pub use crate::bindings::root::TIGER_WRITE_BEHIND_DEFAULT_MAX_PENDING;
+
+/// Opens the files the engine writes (output capture, profiler capture) on a write-behind device:
+/// writes are copied to memory and flushed by a background thread in large sequential writes, so
+/// recording a render through the engine doesn't perturb its timing.
+///
+/// Up to `max_pending_bytes` (see [TIGER_WRITE_BEHIND_DEFAULT_MAX_PENDING]) may wait to be
+/// flushed, past which writes block until the disk catches up. The device always uses a blocking
+/// scheduler, `device_settings.scheduler_type_flags` is overridden accordingly.
+///
+/// Must be called after [init_tiger_stream_mgr]. Pending data is flushed by
+/// [term_tiger_stream_mgr], or earlier by [flush_tiger_write_behind].
+pub fn add_tiger_write_behind_device(
+    device_settings: &mut AkDeviceSettings,
+    max_pending_bytes: usize,
+) -> Result<(), AkResult> {
+    device_settings.scheduler_type_flags = AK_SCHEDULER_BLOCKING;
 
     let device_settings = device_settings.as_ak();
-    ak_call_result![InitTigerStreamMgr(&device_settings)]
+    ak_call_result![InitTigerWriteBehind(&device_settings, max_pending_bytes)]
+}
+
+/// Waits until everything written to the write-behind device so far is on disk, e.g. before
+/// reading a capture that is still open.
+pub fn flush_tiger_write_behind() {
+    unsafe {
+        FlushTigerWriteBehind();
+    }
+}
+
+/// Returns the counters of the write-behind device.
+pub fn tiger_write_behind_stats() -> TigerWriteBehindStats {
+    unsafe {
+        let mut stats: TigerWriteBehindStats = std::mem::zeroed();
+        GetTigerWriteBehindStats(&mut stats);
+        stats
+    }
+}
+
+/// Allocation counters and high-water mark of the buffer pool backing the tiger file cache.
+pub use crate::bindings::root::TigerBufferPoolStats;
+
+/// Sets how much free memory the buffer pool of the tiger file cache keeps for reuse, in bytes.
+///
+/// Package files are read into buffers taken from size-class free lists, backed by the Wwise
+/// memory manager (streaming category). Buffers of evicted files go back to those lists, up to
+/// this amount, and are handed out again to files of a similar size.
+///
+/// *Warning* Must be called after [init_tiger_stream_mgr].
+pub fn set_tiger_buffer_pool_max_retained(max_retained_bytes: usize) {
+    unsafe {
+        SetTigerBufferPoolMaxRetained(max_retained_bytes);
+    }
+}
+
+/// Returns the counters of the buffer pool backing the tiger file cache.
+///
+/// *Warning* Must be called after [init_tiger_stream_mgr].
+pub fn tiger_buffer_pool_stats() -> TigerBufferPoolStats {
+    unsafe {
+        let mut stats: TigerBufferPoolStats = std::mem::zeroed();
+        GetTigerBufferPoolStats(&mut stats);
+        stats
+    }
+}
+
+/// Counters and latency histograms of the tiger streaming manager's device.
+///
+/// `openLatencyUs` and `readLatencyUs` are log2 histograms in microseconds: bucket 0 counts
+/// operations that took less than 1us, bucket `i` those that took `[2^(i-1), 2^i)` us. The last
+/// bucket also counts everything slower.
+///
+/// `uDeadlineMisses` counts reads that completed after the deadline the Stream Manager gave them,
+/// i.e. reads a stream may have starved on. With [TigerIoScheduler::Deferred], the time a read
+/// spent queued counts towards its deadline.
+pub use crate::bindings::root::TigerIoDeviceStats;
+
+/// How much the tiger I/O hooks print to stdout.
+pub use crate::bindings::root::TigerIoTraceLevel;
+
+/// Returns a snapshot of the I/O counters of the device serving `class`. Each device added with
+/// [add_tiger_stream_device] has counters of its own; a class without a device of its own reports
+/// the default device's, which it shares with every other such class.
+///
+/// Counters are updated without locking, so the snapshot is not a consistent cut when transfers
+/// are in flight.
+///
+/// *Warning* Must be called after [init_tiger_stream_mgr].
+pub fn tiger_io_stats(class: TigerDeviceClass) -> TigerIoDeviceStats {
+    unsafe {
+        let mut stats: TigerIoDeviceStats = std::mem::zeroed();
+        GetTigerIoStats(class, &mut stats);
+        stats
+    }
+}
+
+/// Resets the I/O counters and histograms of every device of the tiger streaming manager to zero.
+pub fn reset_tiger_io_stats() {
+    unsafe {
+        ResetTigerIoStats();
+    }
+}
+
+/// Sets how much the tiger I/O hooks trace. Defaults to [TigerIoTraceLevel::TigerIoTraceLevel_Errors].
+pub fn set_tiger_io_trace_level(level: TigerIoTraceLevel) {
+    unsafe {
+        SetTigerIoTraceLevel(level as u32);
+    }
+}
+
+/// Latency added to every transfer of a class of files, see [TigerFaultProfile].
+#[derive(Debug, Default, Copy, Clone, PartialEq)]
+pub enum FaultLatency {
+    /// No latency is added.
+    #[default]
+    None,
+    Fixed(Duration),
+    /// Uniformly distributed between `min` and `max`.
+    Uniform {
+        min: Duration,
+        max: Duration,
+    },
+    /// Exponentially distributed around `mean`, optionally capped at `max`: mostly short, with a
+    /// long tail.
+    Exponential {
+        mean: Duration,
+        max: Option<Duration>,
+    },
+}
+
+/// Faults injected into the transfers of a class of files, see [set_tiger_fault_profile].
+#[derive(Debug, Default, Copy, Clone, PartialEq)]
+pub struct FaultProfile {
+    pub latency: FaultLatency,
+    /// Chance (0 to 1) that a transfer is held for another `spike`, on top of `latency`.
+    pub spike_probability: f32,
+    pub spike: Duration,
+    /// Throughput of the whole class, in bytes per second: its transfers queue behind each other
+    /// as on a saturated disk.
+    pub bandwidth: Option<u64>,
+    /// Chance (0 to 1) that a transfer fails. The Stream Manager handles it like a device read
+    /// error: the stream stops.
+    pub failure_probability: f32,
+}
+
+impl FaultProfile {
+    fn as_ak(&self) -> TigerFaultProfile {
+        let ms = |d: Duration| d.as_secs_f32() * 1000.;
+        let (latency, latency_ms, latency_max_ms) = match self.latency {
+            FaultLatency::None => (TigerFaultLatency::TigerFaultLatency_None, 0., 0.),
+            FaultLatency::Fixed(latency) => {
+                (TigerFaultLatency::TigerFaultLatency_Fixed, ms(latency), 0.)
+            }
+            FaultLatency::Uniform { min, max } => (
+                TigerFaultLatency::TigerFaultLatency_Uniform,
+                ms(min),
+                ms(max),
+            ),
+            FaultLatency::Exponential { mean, max } => (
+                TigerFaultLatency::TigerFaultLatency_Exponential,
+                ms(mean),
+                max.map_or(0., ms),
+            ),
+        };
+
+        TigerFaultProfile {
+            eLatency: latency as u32,
+            fLatencyMs: latency_ms,
+            fLatencyMaxMs: latency_max_ms,
+            fSpikeProbability: self.spike_probability,
+            fSpikeMs: ms(self.spike),
+            uBandwidthBytesPerSec: self.bandwidth.unwrap_or(0),
+            fFailureProbability: self.failure_probability,
+        }
+    }
+}
+
+/// Counters of the injected faults, and of the starvation the engine reported meanwhile (see
+/// [tiger_starvation_events]).
+pub use crate::bindings::root::TigerFaultStats;
+
+/// Injects `profile` into every transfer of the files of `class`, or stops injecting into them
+/// with `None`, to reproduce disk contention on demand.
+///
+/// Classes are those of [add_tiger_stream_device], whether or not they have a device of their
+/// own. Transfers are held on the thread serving them, like a slow disk would hold them, so
+/// starvation shows up in [tiger_io_stats] (`uDeadlineMisses`) and in [tiger_starvation_events].
+/// While any profile is set, io_uring is bypassed.
+///
+/// *Warning* Must be called after [init_tiger_stream_mgr].
+pub fn set_tiger_fault_profile(class: TigerDeviceClass, profile: Option<&FaultProfile>) {
+    let profile = profile.map(FaultProfile::as_ak);
+    unsafe {
+        SetTigerFaultProfile(
+            class,
+            profile.as_ref().map_or(std::ptr::null(), |p| p as *const _),
+        );
+    }
+}
+
+/// Stops injecting faults into every class.
+pub fn clear_tiger_fault_profiles() {
+    for class in [
+        TigerDeviceClass::TigerDeviceClass_Default,
+        TigerDeviceClass::TigerDeviceClass_Banks,
+        TigerDeviceClass::TigerDeviceClass_Streams,
+    ] {
+        set_tiger_fault_profile(class, None);
+    }
+}
+
+/// Seeds the draws of the fault injection, so that a run can be replayed. With several I/O
+/// workers, which transfer gets which fault still depends on scheduling.
+pub fn set_tiger_fault_seed(seed: u64) {
+    unsafe {
+        SetTigerFaultSeed(seed);
+    }
+}
+
+/// Returns the counters of the fault injection.
+pub fn tiger_fault_stats() -> TigerFaultStats {
+    unsafe {
+        let mut stats: TigerFaultStats = std::mem::zeroed();
+        GetTigerFaultStats(&mut stats);
+        stats
+    }
+}
+
+/// Resets the counters of the fault injection, starvation included, and forgets the
+/// [tiger_starvation_events].
+pub fn reset_tiger_fault_stats() {
+    unsafe {
+        ResetTigerFaultStats();
+    }
+    STARVATION_EVENTS.lock().unwrap().clear();
+}
+
+/// Starvation the engine reported, see [tiger_starvation_events].
+#[derive(Debug, Copy, Clone)]
+pub struct StarvationEvent {
+    pub at: Instant,
+    pub code: AK::Monitor::ErrorCode,
+    pub playing_id: AkPlayingID,
+    pub game_obj: AkGameObjectID,
+}
+
+/// Past this many, the oldest starvation events are dropped.
+const MAX_STARVATION_EVENTS: usize = 1024;
+
+lazy_static! {
+    static ref STARVATION_EVENTS: Mutex<VecDeque<StarvationEvent>> = Mutex::new(VecDeque::new());
+}
+
+/// Takes the starvation events (streaming sources, voices and music transitions starving) the
+/// engine reported since the last call, oldest first.
+///
+/// They are collected by [crate::monitoring_callback], which must be the engine's local output
+/// (see [crate::monitor::set_local_output]) with at least the error level. Monitoring is compiled
+/// out of release builds of Wwise.
+pub fn tiger_starvation_events() -> Vec<StarvationEvent> {
+    STARVATION_EVENTS.lock().unwrap().drain(..).collect()
+}
+
+pub(crate) fn record_monitor_error(
+    code: AK::Monitor::ErrorCode,
+    playing_id: AkPlayingID,
+    game_obj: AkGameObjectID,
+) {
+    if !unsafe { RecordTigerMonitorError(code) } {
+        return;
+    }
+
+    let mut events = STARVATION_EVENTS.lock().unwrap();
+    if events.len() >= MAX_STARVATION_EVENTS {
+        events.pop_front();
+    }
+    events.push_back(StarvationEvent {
+        at: Instant::now(),
+        code,
+        playing_id,
+        game_obj,
+    });
 }
 
 pub fn add_base_path<T: AsRef<str>>(location: T) -> Result<(), AkResult> {